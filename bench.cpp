@@ -0,0 +1,901 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "kkjson.h"
+
+using kkjson::parse, kkjson::ParseStatus, kkjson::ParseOptions;
+
+// every allocation of the process, read around a parse for its count. all replaceable forms
+// are counted, std::pmr::new_delete_resource() allocates through the aligned ones.
+static std::atomic<size_t> allocations{0};
+
+static void *counted_alloc(std::size_t n, std::size_t align) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (n == 0)
+        n = 1;
+    if (align <= alignof(std::max_align_t))
+        return std::malloc(n);
+    return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+
+static void *counted_new(std::size_t n, std::size_t align)
+{
+    if (void *p = counted_alloc(n, align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t n) { return counted_new(n, 0); }
+void *operator new[](std::size_t n) { return counted_new(n, 0); }
+void *operator new(std::size_t n, std::align_val_t a) { return counted_new(n, std::size_t(a)); }
+void *operator new[](std::size_t n, std::align_val_t a) { return counted_new(n, std::size_t(a)); }
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept { return counted_alloc(n, 0); }
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept { return counted_alloc(n, 0); }
+void *operator new(std::size_t n, std::align_val_t a, const std::nothrow_t &) noexcept { return counted_alloc(n, std::size_t(a)); }
+void *operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t &) noexcept { return counted_alloc(n, std::size_t(a)); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+
+namespace
+{
+    struct rng
+    {
+        uint64_t state;
+        uint64_t next()
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return state >> 33;
+        }
+    };
+
+    void newline(std::string &out, int indent, int depth)
+    {
+        if (indent == 0)
+            return;
+        out += '\n';
+        out.append(size_t(indent) * depth, ' ');
+    }
+
+    // an array of flat records, pretty printed with `indent` spaces or minified when 0
+    std::string gen_records(size_t count, int indent)
+    {
+        static const char *names[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot"};
+        const char *colon = indent ? ": " : ":";
+        rng r{42};
+        std::string out = "[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                out += ',';
+            newline(out, indent, 1);
+            out += '{';
+            newline(out, indent, 2);
+            out += "\"id\"";
+            out += colon;
+            out += std::to_string(r.next() % 1000000);
+            out += ',';
+            newline(out, indent, 2);
+            out += "\"name\"";
+            out += colon;
+            out += '"';
+            out += names[r.next() % 6];
+            out += '"';
+            out += ',';
+            newline(out, indent, 2);
+            out += "\"active\"";
+            out += colon;
+            out += (r.next() & 1) ? "true" : "false";
+            out += ',';
+            newline(out, indent, 2);
+            out += "\"tags\"";
+            out += colon;
+            out += '[';
+            for (int t = 0; t < 3; t++)
+            {
+                if (t)
+                    out += ',';
+                newline(out, indent, 3);
+                out += '"';
+                out += names[r.next() % 6];
+                out += '"';
+            }
+            newline(out, indent, 2);
+            out += ']';
+            newline(out, indent, 1);
+            out += '}';
+        }
+        newline(out, indent, 0);
+        out += ']';
+        return out;
+    }
+
+    // an array of long, mostly escape-free strings such as log lines and urls
+    std::string gen_strings(size_t count)
+    {
+        static const char *words[] = {"request", "served", "in", "ms", "GET", "/api/v1/items", "user", "session",
+                                      "https://example.com/a/b/c?x=1", "dGhpcyBpcyBiYXNlNjQ=", "ok", "cache"};
+        rng r{7};
+        std::string out = "[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                out += ',';
+            out += '"';
+            size_t n = 8 + r.next() % 24;
+            for (size_t w = 0; w < n; w++)
+            {
+                if (w)
+                    out += ' ';
+                out += words[r.next() % 12];
+            }
+            if (r.next() % 8 == 0)
+                out += "\\n\\\"quoted\\\"";
+            out += '"';
+        }
+        out += ']';
+        return out;
+    }
+
+    // an array of coordinate pairs with full precision floats, like canada.json
+    std::string gen_floats(size_t count)
+    {
+        rng r{11};
+        std::string out = "[";
+        char buf[32];
+        for (size_t i = 0; i < count; i++)
+        {
+            double lon = -180.0 + 360.0 * (r.next() % 100000000) / 1e8 + (r.next() % 1000) * 1e-14;
+            double lat = -90.0 + 180.0 * (r.next() % 100000000) / 1e8 + (r.next() % 1000) * 1e-14;
+            std::snprintf(buf, sizeof(buf), "%s[%.17g,", i ? "," : "", lon);
+            out += buf;
+            std::snprintf(buf, sizeof(buf), "%.17g]", lat);
+            out += buf;
+        }
+        out += ']';
+        return out;
+    }
+
+    // one flat array of doubles
+    std::string gen_flat_floats(size_t count)
+    {
+        rng r{17};
+        std::string out = "[";
+        char buf[32];
+        for (size_t i = 0; i < count; i++)
+        {
+            std::snprintf(buf, sizeof(buf), "%s%.15g", i ? "," : "", (r.next() % 100000000) / 1e4 - 5000.0);
+            out += buf;
+        }
+        out += ']';
+        return out;
+    }
+
+    // an array of chains that alternate objects and arrays `depth` levels down
+    std::string gen_nested(size_t count, size_t depth)
+    {
+        std::string chain;
+        for (size_t d = 0; d < depth; d++)
+            chain += d % 2 ? "[" : "{\"k\":";
+        chain += "1";
+        for (size_t d = depth; d-- > 0;)
+            chain += d % 2 ? "]" : "}";
+        std::string out = "[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                out += ',';
+            out += chain;
+        }
+        out += ']';
+        return out;
+    }
+
+    // an array of integer counters and 64-bit ids
+    std::string gen_integers(size_t count)
+    {
+        rng r{13};
+        std::string out = "[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                out += ',';
+            out += std::to_string(r.next() % 100000);
+            out += ',';
+            out += std::to_string((r.next() << 31) ^ r.next());
+        }
+        out += ']';
+        return out;
+    }
+
+    // one status of a twitter search result, string heavy with a nested user and entities
+    void gen_tweet(rng &r, std::string &out)
+    {
+        static const char *words[] = {"just", "shipped", "the", "new", "release", "#cpp", "@kkjson", "caf\\u00e9",
+                                      "\xe3\x81\x93\xe3\x82\x93\xe3\x81\xab\xe3\x81\xa1\xe3\x81\xaf", "\\ud83d\\ude80",
+                                      "https://t.co/x1Yz", "\\\"quoted\\\"", "rt", "today", "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82"};
+        static const char *names[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot"};
+        std::string id = std::to_string(505874924095815681ULL + r.next() % 1000000);
+        std::string uid = std::to_string(r.next() % 3000000000ULL);
+        const char *name = names[r.next() % 6];
+        out += "{\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"id\":" + id + ",\"id_str\":\"" + id + "\",\"text\":\"";
+        for (size_t w = 0, n = 6 + r.next() % 14; w < n; w++)
+        {
+            if (w)
+                out += ' ';
+            out += words[r.next() % 15];
+        }
+        out += "\",\"source\":\"<a href=\\\"https://mobile.twitter.com\\\" rel=\\\"nofollow\\\">Twitter for iPhone</a>\","
+               "\"truncated\":false,\"in_reply_to_status_id\":null,\"user\":{\"id\":" + uid + ",\"id_str\":\"" + uid +
+               "\",\"name\":\"" + name + " " + names[r.next() % 6] + "\",\"screen_name\":\"" + name + "_" + std::to_string(r.next() % 1000) +
+               "\",\"location\":\"\",\"description\":\"" + words[r.next() % 15] + " " + words[r.next() % 15] +
+               "\",\"followers_count\":" + std::to_string(r.next() % 100000) + ",\"friends_count\":" + std::to_string(r.next() % 5000) +
+               ",\"verified\":" + ((r.next() & 7) == 0 ? "true" : "false") +
+               ",\"profile_image_url\":\"http://pbs.twimg.com/profile_images/" + uid + "/avatar_normal.jpeg\"},"
+               "\"geo\":null,\"coordinates\":null,\"retweet_count\":" + std::to_string(r.next() % 500) +
+               ",\"favorite_count\":" + std::to_string(r.next() % 500) + ",\"entities\":{\"hashtags\":[";
+        for (size_t h = 0, n = r.next() % 3; h < n; h++)
+        {
+            size_t at = r.next() % 100;
+            out += std::string(h ? "," : "") + "{\"text\":\"" + names[r.next() % 6] + "\",\"indices\":[" + std::to_string(at) +
+                   "," + std::to_string(at + 6) + "]}";
+        }
+        out += "],\"urls\":[],\"user_mentions\":[]},\"favorited\":false,\"retweeted\":false,\"lang\":\"ja\"}";
+    }
+
+    // a search result like twitter.json
+    std::string gen_tweets(size_t count)
+    {
+        rng r{19};
+        std::string out = "{\"statuses\":[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                out += ',';
+            gen_tweet(r, out);
+        }
+        out += "],\"search_metadata\":{\"completed_in\":0.087,\"count\":" + std::to_string(count) + "}}";
+        return out;
+    }
+
+    // the same statuses as a log, one per line
+    std::string gen_tweet_lines(size_t count)
+    {
+        rng r{19};
+        std::string out;
+        for (size_t i = 0; i < count; i++)
+        {
+            gen_tweet(r, out);
+            out += '\n';
+        }
+        return out;
+    }
+
+    // one object with n members of mixed types
+    std::string gen_wide_object(size_t n)
+    {
+        rng r{23};
+        std::string out = "{";
+        for (size_t i = 0; i < n; i++)
+        {
+            out += (i ? ",\"" : "\"") + std::string("member_") + std::to_string(i * 7919 % 1000003) + "\":";
+            switch (r.next() % 3)
+            {
+            case 0:
+                out += std::to_string(r.next() % 1000000);
+                break;
+            case 1:
+                out += "\"value " + std::to_string(r.next() % 1000) + "\"";
+                break;
+            default:
+                out += "[true,null," + std::to_string(r.next() % 100) + "]";
+                break;
+            }
+        }
+        out += '}';
+        return out;
+    }
+
+    volatile double sink;
+
+    // calls f until about a second has passed and returns the seconds per call
+    template <class F>
+    double time_per_call(F &&f)
+    {
+        using clock = std::chrono::steady_clock;
+        size_t rounds = 0;
+        auto start = clock::now();
+        double elapsed;
+        do
+        {
+            f();
+            rounds++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < 1.0);
+        return elapsed / rounds;
+    }
+
+    // building, looking up every key of and iterating over an object of n members
+    void bench_object(size_t n)
+    {
+        std::string doc = "{";
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < n; i++)
+        {
+            keys.push_back("member_" + std::to_string(i * 7919 % 100003));
+            doc += (i ? ",\"" : "\"") + keys.back() + "\":" + std::to_string(i);
+        }
+        doc += '}';
+        auto [status, js] = parse(doc);
+        if (status != ParseStatus::OK)
+            return;
+
+        double build = time_per_call([&doc]
+                                     { auto r = parse(doc); });
+        double sum = 0;
+        double lookup = time_per_call([&]
+                                      { for (auto &k : keys) sum += js[k].as_number(); });
+        double iterate = time_per_call([&]
+                                       { for (auto it = js.object_begin(); it != js.object_end(); ++it) sum += it->second.as_number(); });
+        sink = sum;
+        std::printf("object/%-6zu build %8.1f ns/member  lookup %6.1f ns  iterate %5.2f ns/member\n",
+                    n, build * 1e9 / n, lookup * 1e9 / n, iterate * 1e9 / n);
+    }
+
+    void bench_parse(const char *label, const std::string &doc, const ParseOptions &opts = ParseOptions())
+    {
+        using clock = std::chrono::steady_clock;
+        size_t rounds = 0;
+        auto start = clock::now();
+        double elapsed;
+        do
+        {
+            auto [status, js] = parse(doc, opts);
+            if (status != ParseStatus::OK)
+            {
+                std::printf("%-12s parse failed\n", label);
+                return;
+            }
+            rounds++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < 1.0);
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB %10.2f MB/s\n", label, mb, mb * rounds / elapsed);
+    }
+
+    // serializes the parsed doc, output size is what the MB/s refer to
+    void bench_dump(const char *label, const std::string &doc, const kkjson::DumpOptions &opts)
+    {
+        auto [status, js] = parse(doc);
+        if (status != ParseStatus::OK)
+        {
+            std::printf("%-12s parse failed\n", label);
+            return;
+        }
+        size_t out = 0;
+        double t = time_per_call([&]
+                                 { out = js.dump(opts).size(); });
+        double mb = out / 1e6;
+        std::printf("%-12s %8.2f MB %10.2f MB/s\n", label, mb, mb / t);
+    }
+
+    double sum_values(const kkjson::Value &v)
+    {
+        double sum = 0;
+        if (v.is_number())
+            return v.as_number();
+        if (v.is_array())
+            for (auto it = v.array_begin(); it != v.array_end(); ++it)
+                sum += sum_values(*it);
+        if (v.is_object())
+            for (auto it = v.object_begin(); it != v.object_end(); ++it)
+                sum += sum_values(it->second);
+        return sum;
+    }
+
+    double sum_values(const kkjson::TapeValue &v)
+    {
+        double sum = 0;
+        if (v.is_number())
+            return v.as_number();
+        if (v.is_array())
+            for (auto it = v.array_begin(); it != v.array_end(); ++it)
+                sum += sum_values(*it);
+        if (v.is_object())
+            for (auto it = v.object_begin(); it != v.object_end(); ++it)
+                sum += sum_values(it->second);
+        return sum;
+    }
+
+    // parse, read every number once and drop, as a Value tree and as a reused Tape
+    void bench_read_once(const char *label, const std::string &doc)
+    {
+        kkjson::Tape tape;
+        double tree = time_per_call([&]
+                                    { auto [st, js] = parse(doc); sink = sum_values(js); });
+        double flat = time_per_call([&]
+                                    { tape.parse(doc); sink = sum_values(tape.root()); });
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  value %8.2f MB/s  tape %8.2f MB/s\n", label, mb, mb / tree, mb / flat);
+    }
+
+    // reads one field of one record, with a full parse and on demand
+    void bench_lazy(const char *label, const std::string &doc, size_t idx)
+    {
+        double full = time_per_call([&]
+                                    { auto [st, js] = parse(doc); sink = js[idx]["id"].as_number(); });
+        double lazy = time_per_call([&]
+                                    {
+                                        auto [st, root] = kkjson::parse_lazy(doc);
+                                        auto [st2, id] = root.at(idx).second.find("id");
+                                        sink = id.get().second.as_number(); });
+        std::printf("%-12s full %10.1f us  lazy %10.1f us\n", label, full * 1e6, lazy * 1e6);
+    }
+
+    struct sax_sum final : kkjson::SaxHandler
+    {
+        double sum = 0;
+
+        bool null() override { return true; }
+        bool boolean(bool) override { return true; }
+        bool number(double v) override
+        {
+            sum += v;
+            return true;
+        }
+        bool string(std::string_view) override { return true; }
+        bool key(std::string_view) override { return true; }
+        bool start_object() override { return true; }
+        bool end_object() override { return true; }
+        bool start_array() override { return true; }
+        bool end_array() override { return true; }
+    };
+
+    // sums every number, from a Value tree and from SAX events without one
+    void bench_sax(const char *label, const std::string &doc)
+    {
+        double tree = time_per_call([&]
+                                    { auto [st, js] = parse(doc); sink = sum_values(js); });
+        double events = time_per_call([&]
+                                      { sax_sum h; kkjson::parse_sax(doc, h); sink = h.sum; });
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  value %8.2f MB/s  sax    %8.2f MB/s\n", label, mb, mb / tree, mb / events);
+    }
+
+    // feeds the document in network-sized chunks, into a tree and as events
+    void bench_stream(const char *label, const std::string &doc, size_t chunk)
+    {
+        kkjson::StreamParser tree;
+        sax_sum h;
+        kkjson::StreamParser events(h);
+        auto feed_all = [&](kkjson::StreamParser &sp)
+        {
+            sp.reset();
+            for (size_t pos = 0; pos < doc.size(); pos += chunk)
+                sp.feed(doc.data() + pos, std::min(chunk, doc.size() - pos));
+            sp.finish();
+        };
+        double dom = time_per_call([&]
+                                   { feed_all(tree); sink = tree.root().get_size(); });
+        double sax = time_per_call([&]
+                                   { feed_all(events); sink = h.sum; });
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  value %8.2f MB/s  sax    %8.2f MB/s\n", label, mb, mb / dom, mb / sax);
+    }
+
+    // one record of the array per line
+    std::string to_ndjson(const std::string &doc)
+    {
+        std::string out;
+        auto [st, js] = parse(doc);
+        for (auto it = js.array_begin(); it != js.array_end(); ++it)
+            out += it->dump() + '\n';
+        return out;
+    }
+
+    void bench_ndjson(const char *label, const std::string &lines, unsigned threads)
+    {
+        kkjson::NdjsonOptions opts;
+        opts.threads = threads;
+        size_t docs = 0;
+        double t = time_per_call([&]
+                                 { docs = kkjson::parse_ndjson(lines, opts).size(); });
+        double mb = lines.size() / 1e6;
+        std::printf("%-12s %8.2f MB %10.2f MB/s %10.0f docs/s\n", label, mb, mb / t, docs / t);
+    }
+
+    // the id of every record, from a full tree and from a compiled query
+    void bench_query(const char *label, const std::string &doc, const char *path)
+    {
+        kkjson::Query q;
+        q.add(path);
+        double full = time_per_call([&]
+                                    {
+                                        auto [st, js] = parse(doc);
+                                        double sum = 0;
+                                        for (auto it = js.array_begin(); it != js.array_end(); ++it)
+                                            sum += (*it)["id"].as_number();
+                                        sink = sum; });
+        double query = time_per_call([&]
+                                     {
+                                         auto [st, matches] = q.run(doc);
+                                         double sum = 0;
+                                         for (auto &m : matches)
+                                             sum += m.value.as_number();
+                                         sink = sum; });
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  parse %8.2f MB/s  query  %8.2f MB/s\n", label, mb, mb / full, mb / query);
+    }
+
+    // the same lines with every key and short value copied per document and taken from one pool
+    void bench_intern(const char *label, const std::string &lines)
+    {
+        kkjson::StringPool pool;
+        kkjson::NdjsonOptions copied, pooled;
+        copied.threads = pooled.threads = 1;
+        pooled.parse.intern = &pool;
+        double plain = time_per_call([&]
+                                     { sink = kkjson::parse_ndjson(lines, copied).size(); });
+        double interned = time_per_call([&]
+                                        { sink = kkjson::parse_ndjson(lines, pooled).size(); });
+        double mb = lines.size() / 1e6;
+        std::printf("%-12s %8.2f MB  copied %8.2f MB/s  pooled %8.2f MB/s  %zu strings\n", label, mb, mb / plain,
+                    mb / interned, pool.size());
+    }
+
+    // memory a flat numeric array takes as Values and on a Tape, and the time to sum it from each
+    void bench_numeric(const char *label, const std::string &doc)
+    {
+        auto [st, js] = parse(doc);
+        kkjson::Tape tape;
+        tape.parse(doc);
+        double tree_sum = time_per_call([&]
+                                        {
+                                            double sum = 0;
+                                            for (auto it = js.array_begin(); it != js.array_end(); ++it)
+                                                sum += it->as_number();
+                                            sink = sum; });
+        double tape_sum = time_per_call([&]
+                                        {
+                                            double sum = 0;
+                                            auto root = tape.root();
+                                            for (auto it = root.array_begin(); it != root.array_end(); ++it)
+                                                sum += it->as_number();
+                                            sink = sum; });
+        double tree_parse = time_per_call([&]
+                                          { sink = parse(doc).second.get_size(); });
+        double tape_parse = time_per_call([&]
+                                          { sink = size_t(tape.parse(doc)); });
+        size_t n = js.get_size();
+        std::printf("%-12s %8zu elems  Value %6.1f MB %8.2f ms scan %8.2f ms parse  Tape %6.1f MB %8.2f ms scan %8.2f ms parse\n",
+                    label, n, n * sizeof(kkjson::Value) / 1e6, tree_sum * 1e3, tree_parse * 1e3, tape.bytes() / 1e6, tape_sum * 1e3,
+                    tape_parse * 1e3);
+    }
+
+    // a full parse against checking the same bytes without building anything
+    void bench_validate(const char *label, const std::string &doc)
+    {
+        double full = time_per_call([&]
+                                    { sink = parse(doc).second.get_size(); });
+        double check = time_per_call([&]
+                                     { sink = size_t(kkjson::validate(doc).first); });
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  parse %8.2f MB/s  validate %8.2f MB/s\n", label, mb, mb / full, mb / check);
+    }
+
+    // many small messages, a fresh parser per call against one kept Parser
+    void bench_small(const char *label, const std::string &lines)
+    {
+        std::vector<std::string> msgs;
+        for (size_t pos = 0, nl; (nl = lines.find('\n', pos)) != std::string::npos && msgs.size() < 10000; pos = nl + 1)
+            msgs.push_back("[" + lines.substr(pos, nl - pos) + ", \"caf\\u00e9\"]");
+        kkjson::Parser reused;
+        double fresh = time_per_call([&]
+                                     { for (auto &m : msgs) sink = parse(m).second.get_size(); });
+        double kept = time_per_call([&]
+                                    { for (auto &m : msgs) sink = reused.parse(m).second.get_size(); });
+        std::printf("%-12s %8zu docs  parse %10.0f docs/s  Parser %10.0f docs/s\n", label, msgs.size(),
+                    msgs.size() / fresh, msgs.size() / kept);
+    }
+
+    // reading the file into a string first against mapping it
+    void bench_file(const char *label, const std::string &doc)
+    {
+        const char *path = "/tmp/kkjson_bench.json";
+        FILE *f = std::fopen(path, "wb");
+        std::fwrite(doc.data(), 1, doc.size(), f);
+        std::fclose(f);
+        double read = time_per_call([&]
+                                    {
+                                        std::string buf;
+                                        FILE *in = std::fopen(path, "rb");
+                                        std::fseek(in, 0, SEEK_END);
+                                        buf.resize(std::ftell(in));
+                                        std::rewind(in);
+                                        sink = std::fread(&buf[0], 1, buf.size(), in);
+                                        std::fclose(in);
+                                        auto [st, js] = parse(buf);
+                                        sink = js.get_size(); });
+        double mapped = time_per_call([&]
+                                      { auto [st, js] = kkjson::parse_file(path); sink = js.get_size(); });
+        std::remove(path);
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB  read %8.2f MB/s  mmap   %8.2f MB/s\n", label, mb, mb / read, mb / mapped);
+    }
+
+    // parses into one reused arena Document, teardown included
+    void bench_document(const char *label, const std::string &doc, const ParseOptions &opts = ParseOptions())
+    {
+        using clock = std::chrono::steady_clock;
+        kkjson::Document d;
+        size_t rounds = 0;
+        auto start = clock::now();
+        double elapsed;
+        do
+        {
+            if (d.parse(doc, opts) != ParseStatus::OK)
+            {
+                std::printf("%-12s parse failed\n", label);
+                return;
+            }
+            rounds++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < 1.0);
+        double mb = doc.size() / 1e6;
+        std::printf("%-12s %8.2f MB %10.2f MB/s\n", label, mb, mb * rounds / elapsed);
+    }
+
+    // resident set size in kB as /proc/self/status reports it, field is VmRSS or VmHWM.
+    // 0 without procfs.
+    size_t rss_kb(const char *field)
+    {
+        FILE *f = std::fopen("/proc/self/status", "r");
+        if (f == nullptr)
+            return 0;
+        char line[256];
+        size_t kb = 0, n = std::strlen(field);
+        while (std::fgets(line, sizeof(line), f) != nullptr)
+        {
+            if (std::strncmp(line, field, n) == 0 && line[n] == ':')
+            {
+                kb = std::strtoull(line + n + 1, nullptr, 10);
+                break;
+            }
+        }
+        std::fclose(f);
+        return kb;
+    }
+
+    // hands freed memory back and lets VmHWM start over from the current RSS
+    void reset_peak_rss()
+    {
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        if (FILE *f = std::fopen("/proc/self/clear_refs", "w"))
+        {
+            std::fputs("5", f);
+            std::fclose(f);
+        }
+    }
+
+    // every number and every string and key byte
+    double touch_all(const kkjson::Value &v)
+    {
+        double sum = 0;
+        if (v.is_number())
+            return v.as_number();
+        if (v.is_string())
+            return double(v.get_size());
+        if (v.is_array())
+            for (auto it = v.array_begin(); it != v.array_end(); ++it)
+                sum += touch_all(*it);
+        if (v.is_object())
+            for (auto it = v.object_begin(); it != v.object_end(); ++it)
+                sum += double(it->first.size()) + touch_all(it->second);
+        return sum;
+    }
+
+    // the regression suite: the documents of a corpus are parsed one after another, read
+    // completely, dumped and destroyed, each phase timed on its own. MB/s refer to the input,
+    // for dump to the output. peak is the RSS growth over the process before the first parse.
+    void bench_suite(const char *label, const std::vector<std::string_view> &docs, bool csv)
+    {
+        using clock = std::chrono::steady_clock;
+        std::vector<kkjson::Value> trees(docs.size());
+        size_t bytes = 0, dumped = 0, allocs = 0, rounds = 0;
+        double t_parse = 0, t_access = 0, t_dump = 0, t_destroy = 0;
+        for (auto d : docs)
+            bytes += d.size();
+        reset_peak_rss();
+        size_t base_kb = rss_kb("VmRSS");
+        do
+        {
+            auto t0 = clock::now();
+            size_t before = allocations.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < docs.size(); i++)
+            {
+                auto [status, js] = parse(docs[i]);
+                if (status != ParseStatus::OK)
+                {
+                    std::printf("%-12s parse failed\n", label);
+                    return;
+                }
+                trees[i] = std::move(js);
+            }
+            allocs += allocations.load(std::memory_order_relaxed) - before;
+            auto t1 = clock::now();
+            for (auto &js : trees)
+                sink = touch_all(js);
+            auto t2 = clock::now();
+            for (auto &js : trees)
+                dumped += js.dump().size();
+            auto t3 = clock::now();
+            for (auto &js : trees)
+                js = kkjson::Value();
+            auto t4 = clock::now();
+            t_parse += std::chrono::duration<double>(t1 - t0).count();
+            t_access += std::chrono::duration<double>(t2 - t1).count();
+            t_dump += std::chrono::duration<double>(t3 - t2).count();
+            t_destroy += std::chrono::duration<double>(t4 - t3).count();
+            rounds++;
+        } while (t_parse + t_access + t_dump + t_destroy < 1.0);
+        size_t peak_kb = rss_kb("VmHWM");
+        double mb = bytes / 1e6, n = double(docs.size()) * rounds;
+        double peak = peak_kb > base_kb ? (peak_kb - base_kb) / 1e3 : 0;
+        std::printf(csv ? "%s,%.2f,%zu,%.2f,%.0f,%.1f,%.2f,%.2f,%.2f,%.1f\n"
+                        : "%-12s %8.2f %8zu %10.2f %10.0f %10.1f %10.2f %10.2f %10.2f %8.1f\n",
+                    label, mb, docs.size(), mb * rounds / t_parse, n / t_parse, allocs / n, mb * rounds / t_access,
+                    dumped / 1e6 / t_dump, mb * rounds / t_destroy, peak);
+    }
+
+    void run_suite(bool csv)
+    {
+        // every object owns its member storage, a count below one per object misses an allocation path
+        std::string objects = "[";
+        for (int i = 0; i < 1000; i++)
+            objects += i ? ",{\"a\":1,\"b\":2}" : "{\"a\":1,\"b\":2}";
+        objects += "]";
+        size_t before = allocations.load(std::memory_order_relaxed);
+        parse(objects);
+        size_t counted = allocations.load(std::memory_order_relaxed) - before;
+        if (counted < 1000)
+        {
+            std::printf("allocation count broken: %zu for 1000 objects\n", counted);
+            std::exit(1);
+        }
+
+        std::printf(csv ? "corpus,mb,docs,parse_mb_s,docs_s,allocs_doc,access_mb_s,dump_mb_s,destroy_mb_s,peak_mb\n"
+                        : "%-12s %8s %8s %10s %10s %10s %10s %10s %10s %8s\n",
+                    "corpus", "MB", "docs", "parse MB/s", "docs/s", "allocs/doc", "access", "dump", "destroy", "peak MB");
+        std::string tweets = gen_tweets(20000);
+        bench_suite("twitter", {tweets}, csv);
+        std::string floats = gen_floats(100000);
+        bench_suite("canada", {floats}, csv);
+        std::string deep = gen_nested(2000, 512);
+        bench_suite("deep", {deep}, csv);
+        std::string wide = gen_wide_object(200000);
+        bench_suite("object", {wide}, csv);
+        std::string lines = gen_tweet_lines(20000);
+        std::vector<std::string_view> docs;
+        for (size_t pos = 0, nl; (nl = lines.find('\n', pos)) != std::string::npos; pos = nl + 1)
+            docs.push_back(std::string_view(lines).substr(pos, nl - pos));
+        bench_suite("ndjson", docs, csv);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool csv = false, suite_only = false;
+    for (int i = 1; i < argc; i++)
+    {
+        csv |= std::strcmp(argv[i], "--csv") == 0;
+        suite_only |= std::strcmp(argv[i], "--suite") == 0;
+    }
+    run_suite(csv);
+    if (csv || suite_only)
+        return 0;
+
+    std::string minified = gen_records(50000, 0);
+    std::string indented = gen_records(50000, 4);
+    std::string strings = gen_strings(50000);
+    std::string floats = gen_floats(100000);
+    std::string integers = gen_integers(200000);
+    bench_parse("minified", minified);
+    bench_parse("indented", indented);
+    bench_parse("strings", strings);
+    bench_parse("floats", floats);
+    bench_parse("integers", integers);
+
+    ParseOptions borrow;
+    borrow.borrow_strings = true;
+    bench_parse("minified/b", minified, borrow);
+    bench_parse("strings/b", strings, borrow);
+
+    ParseOptions indexed;
+    indexed.structural_index = true;
+    bench_parse("minified/i", minified, indexed);
+    bench_parse("indented/i", indented, indexed);
+    bench_parse("strings/i", strings, indexed);
+    bench_parse("floats/i", floats, indexed);
+
+    ParseOptions split;
+    split.threads = 4;
+    bench_parse("minified/t4", minified, split);
+    bench_parse("floats/t4", floats, split);
+
+    bench_file("file/min", minified);
+    bench_file("file/str", strings);
+
+    bench_document("minified/d", minified);
+    bench_document("strings/d", strings);
+
+    bench_read_once("read/min", minified);
+    bench_read_once("read/float", floats);
+
+    bench_sax("sax/min", minified);
+    bench_sax("sax/float", floats);
+
+    bench_stream("stream/4k", minified, 4096);
+    bench_stream("stream/64", minified, 64);
+
+    std::string nested = gen_nested(20000, 64);
+    bench_parse("nested", nested);
+    bench_parse("nested/i", nested, indexed);
+
+    std::string ndjson = to_ndjson(minified);
+    bench_ndjson("ndjson/1t", ndjson, 1);
+    bench_ndjson("ndjson/all", ndjson, 0);
+    bench_small("small", ndjson);
+    bench_intern("intern", ndjson);
+
+    bench_query("query/ids", minified, "$[*].id");
+
+    bench_validate("valid/min", minified);
+    bench_validate("valid/ind", indented);
+    bench_validate("valid/str", strings);
+    bench_validate("valid/float", floats);
+    bench_validate("valid/int", integers);
+
+    std::string flat = gen_flat_floats(1000000);
+    std::string ints = gen_integers(500000);
+    bench_numeric("numeric/flt", flat);
+    bench_numeric("numeric/int", ints);
+
+    bench_lazy("lazy/first", minified, 0);
+    bench_lazy("lazy/mid", minified, 25000);
+
+    kkjson::DumpOptions compact, pretty, exact;
+    pretty.indent = 4;
+    exact.exact_size = true;
+    bench_dump("dump/min", minified, compact);
+    bench_dump("dump/ind", minified, pretty);
+    bench_dump("dump/exact", minified, exact);
+    bench_dump("dump/str", strings, compact);
+    bench_dump("dump/float", floats, compact);
+
+    for (size_t n : {4, 32, 10000})
+        bench_object(n);
+    return 0;
+}
@@ -1,8 +1,29 @@
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "kkjson.h"
 
+#if !defined(KKJSON_NO_SIMD) && defined(__AVX2__)
+#define KKJSON_AVX2
+#include <immintrin.h>
+#elif !defined(KKJSON_NO_SIMD) && defined(__SSE2__)
+#define KKJSON_SSE2
+#include <emmintrin.h>
+#endif
+
 #pragma region tools
 
 // char stack
@@ -10,11 +31,63 @@
 #define EXTEND_SIZE(x) (x += x >> 1)
 #define PUSH_CHAR(stk, c) (*(char *)stk.push(1) = c)
 
+// object storage, members are scanned linearly up to the threshold
+#define OBJECT_INDEX_THRESHOLD 16
+#define OBJECT_INDEX_MIN_CAP 64
+
+// serializer, a number never takes more than DUMP_NUMBER_MAX bytes
+#define DUMP_INIT_CAP 256
+#define DUMP_NUMBER_MAX 32
+
+// threads option, the least bytes a part of a split array is given
+#define PARALLEL_MIN_PART (1 << 18)
+
+// query, marks an active path whose key step already matched a member of the current object
+#define QUERY_TAKEN 0x80000000u
+
+// ndjson, documents a worker claims at once and bytes parse_ndjson_fd reads per batch
+#define NDJSON_CLAIM 64
+#define NDJSON_READ_BLOCK (1 << 20)
+
+// string pool, slots of an empty table
+#define INTERN_INIT_SLOTS 256
+
+// tape words, NaN-boxed. a double is stored as it is, parsed numbers are always finite.
+// every other word is a negative NaN: twelve set bits, a 4-bit tag code and a 48-bit payload.
+// a container start keeps its element count, saturated, above the position after its end.
+#define TAPE_BOX 0xFFF0000000000000ull
+// the codes are positions in TAPE_TAGS, which only the readers use
+#define TAPE_TAGS "?nft\"[]{}ilu"
+#define TAPE_CODE_NULL 1
+#define TAPE_CODE_FALSE 2
+#define TAPE_CODE_TRUE 3
+#define TAPE_CODE_STRING 4
+#define TAPE_CODE_ARRAY 5
+#define TAPE_CODE_ARRAY_END 6
+#define TAPE_CODE_OBJECT 7
+#define TAPE_CODE_OBJECT_END 8
+#define TAPE_CODE_INT 9
+#define TAPE_CODE_INT64 10
+#define TAPE_CODE_UINT64 11
+#define TAPE_WORD(code, payload) (TAPE_BOX | (uint64_t(code) << 48) | uint64_t(payload))
+#define TAPE_TAG(w) (((w) & TAPE_BOX) == TAPE_BOX ? TAPE_TAGS[((w) >> 48) & 0xF] : 'd')
+#define TAPE_PAYLOAD(w) ((w) & ((uint64_t(1) << 48) - 1))
+#define TAPE_END_BITS 36
+#define TAPE_END(w) ((w) & ((uint64_t(1) << TAPE_END_BITS) - 1))
+#define TAPE_COUNT(w) (TAPE_PAYLOAD(w) >> TAPE_END_BITS)
+#define TAPE_COUNT_MAX 0xFFF
+// integers in this many bits share the word of their tag, wider ones take the next word
+#define TAPE_INT_BITS 48
+#define TAPE_INT(w) (int64_t((w) << (64 - TAPE_INT_BITS)) >> (64 - TAPE_INT_BITS))
+
 // char handle
 #define IS_WHITESPACE(x) ((x) == ' ' || (x) == '\t' || (x) == '\n' || (x) == '\r')
-#define IS_ZEROEND(x) ((x) == '\0')
+#define PEEK_AT(p, end) ((p) != (end) ? *(p) : '\0')
 #define IS_DIGIT09(x) ((x) >= '0' && (x) <= '9')
 #define IS_DIGIT19(x) ((x) >= '1' && (x) <= '9')
+// bytes a number or literal can be made of, a run of them is one token for the stream parser
+#define IS_TOKEN_CHAR(x) (IS_DIGIT09(x) || ((x) >= 'a' && (x) <= 'z') || ((x) >= 'A' && (x) <= 'Z') || \
+                          (x) == '-' || (x) == '+' || (x) == '.')
 #define IS_SURROGATE_H(x) ((x) >= 0xD800 && (x) <= 0xDBFF)
 #define IS_SURROGATE_L(x) ((x) < 0xDC00 || (x) > 0xDFFF)
 #define CALC_CODEPOINT(uh, ul) ((((uh - 0xD800) << 10) | (ul - 0xDC00)) + 0x10000)
@@ -41,6 +114,951 @@ static bool hex4_to_ui(const char *iter, unsigned &ux)
 
 #pragma endregion
 
+#pragma region simd
+
+// first non-whitespace byte in [p, end). padded input lets the last block be loaded across end.
+static const char *skip_whitespace(const char *p, const char *end, bool padded)
+{
+#if defined(KKJSON_AVX2)
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'),
+                  lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    while (padded ? p < end : end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, tab)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(ws);
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return p < end ? p : end;
+        }
+        p += 32;
+    }
+    if (p >= end)
+        return end;
+#elif defined(KKJSON_SSE2)
+    const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'),
+                  lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    while (padded ? p < end : end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(ws) & 0xFFFF;
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return p < end ? p : end;
+        }
+        p += 16;
+    }
+    if (p >= end)
+        return end;
+#else
+    (void)padded;
+#endif
+    while (p != end && IS_WHITESPACE(*p))
+        p++;
+    return p;
+}
+
+// first '"', '\\' or control byte in [p, end), or end. everything before it is copied verbatim.
+static const char *scan_string(const char *p, const char *end, bool padded)
+{
+#if defined(KKJSON_AVX2)
+    const __m256i quote = _mm256_set1_epi8('"'), bslash = _mm256_set1_epi8('\\'),
+                  ctrl = _mm256_set1_epi8(0x1F);
+    while (padded ? p < end : end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)),
+                                      _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return p < end ? p : end;
+        }
+        p += 32;
+    }
+    if (p >= end)
+        return end;
+#elif defined(KKJSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"'), bslash = _mm_set1_epi8('\\'),
+                  ctrl = _mm_set1_epi8(0x1F);
+    while (padded ? p < end : end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+                                   _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return p < end ? p : end;
+        }
+        p += 16;
+    }
+    if (p >= end)
+        return end;
+#else
+    (void)padded;
+#endif
+    while (p != end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20)
+        p++;
+    return p;
+}
+
+// one bit per byte of a 64-byte block
+struct block_masks
+{
+    uint64_t quote, backslash, op, space;
+};
+
+static void classify_block(const char *p, block_masks &m)
+{
+#if defined(KKJSON_AVX2)
+    const __m256i quote = _mm256_set1_epi8('"'), bslash = _mm256_set1_epi8('\\'),
+                  sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'),
+                  lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r'),
+                  comma = _mm256_set1_epi8(','), colon = _mm256_set1_epi8(':'),
+                  lbrace = _mm256_set1_epi8('{'), rbrace = _mm256_set1_epi8('}'),
+                  lbracket = _mm256_set1_epi8('['), rbracket = _mm256_set1_epi8(']');
+    m = block_masks{0, 0, 0, 0};
+    for (int i = 0; i < 2; i++)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + 32 * i));
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, tab)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, colon)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, lbrace), _mm256_cmpeq_epi8(v, rbrace))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lbracket), _mm256_cmpeq_epi8(v, rbracket)));
+        m.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << (32 * i);
+        m.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bslash)))) << (32 * i);
+        m.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << (32 * i);
+        m.space |= uint64_t(uint32_t(_mm256_movemask_epi8(ws))) << (32 * i);
+    }
+#elif defined(KKJSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"'), bslash = _mm_set1_epi8('\\'),
+                  sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'),
+                  lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r'),
+                  comma = _mm_set1_epi8(','), colon = _mm_set1_epi8(':'),
+                  lbrace = _mm_set1_epi8('{'), rbrace = _mm_set1_epi8('}'),
+                  lbracket = _mm_set1_epi8('['), rbracket = _mm_set1_epi8(']');
+    m = block_masks{0, 0, 0, 0};
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, colon)),
+                                               _mm_or_si128(_mm_cmpeq_epi8(v, lbrace), _mm_cmpeq_epi8(v, rbrace))),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, lbracket), _mm_cmpeq_epi8(v, rbracket)));
+        m.quote |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote))) << (16 * i);
+        m.backslash |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash))) << (16 * i);
+        m.op |= uint64_t(_mm_movemask_epi8(op)) << (16 * i);
+        m.space |= uint64_t(_mm_movemask_epi8(ws)) << (16 * i);
+    }
+#else
+    m = block_masks{0, 0, 0, 0};
+    for (int i = 0; i < 64; i++)
+    {
+        uint64_t bit = uint64_t(1) << i;
+        switch (p[i])
+        {
+        case '"':
+            m.quote |= bit;
+            break;
+        case '\\':
+            m.backslash |= bit;
+            break;
+        case ',':
+        case ':':
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+            m.op |= bit;
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            m.space |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+#endif
+}
+
+// bit i is the xor of bits 0..i, turns quote positions into the inside of strings
+static uint64_t prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// bytes preceded by an odd run of backslashes. prev_escaped carries a run across blocks.
+static uint64_t find_escaped(uint64_t backslash, uint64_t &prev_escaped)
+{
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    backslash &= ~prev_escaped;
+    uint64_t follows_escape = backslash << 1 | prev_escaped;
+    uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t even_sequences;
+    prev_escaped = __builtin_add_overflow(odd_starts, backslash, &even_sequences);
+    return (even_bits ^ (even_sequences << 1)) & follows_escape;
+}
+
+#pragma endregion
+
+#pragma region number conversion
+
+// decimal to double: Clinger's fast path for small exact inputs, Eisel-Lemire for
+// up to 19 significant digits and a big decimal for the rare ambiguous leftovers
+
+#define MANTISSA_MAX_DIGITS 19
+#define MANTISSA_EXPLICIT_BITS 52
+#define BINARY_MIN_EXPONENT (-1023)
+#define BINARY_INFINITE_POWER 0x7FF
+#define POW5_SMALLEST (-342)
+#define POW5_LARGEST 308
+#define DECIMAL_MAX_DIGITS 768
+#define DECIMAL_POINT_RANGE 2047
+
+struct adjusted_mantissa
+{
+    uint64_t mantissa;
+    int32_t power2;
+    bool operator==(const adjusted_mantissa &rhs) const { return mantissa == rhs.mantissa && power2 == rhs.power2; }
+};
+
+// 5^q for q in [POW5_SMALLEST, POW5_LARGEST] normalized to 128 bits, high word first
+static const uint64_t pow5_128[2 * (POW5_LARGEST - POW5_SMALLEST + 1)] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, 0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, 0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, 0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, 0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, 0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, 0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, 0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, 0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, 0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, 0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, 0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, 0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, 0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, 0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, 0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, 0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, 0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, 0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, 0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, 0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, 0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, 0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, 0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, 0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, 0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, 0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, 0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, 0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, 0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, 0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, 0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, 0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, 0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, 0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, 0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, 0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, 0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, 0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, 0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, 0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL, 0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, 0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, 0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, 0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, 0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, 0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL, 0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, 0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, 0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL, 0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL, 0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, 0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, 0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, 0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, 0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, 0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, 0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, 0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, 0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, 0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL, 0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, 0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, 0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, 0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, 0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, 0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, 0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, 0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL, 0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, 0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, 0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, 0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, 0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, 0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL, 0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, 0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, 0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, 0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, 0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, 0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, 0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, 0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, 0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, 0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, 0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, 0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, 0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, 0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, 0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, 0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, 0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, 0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, 0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, 0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, 0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, 0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, 0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, 0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, 0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, 0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, 0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, 0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, 0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, 0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, 0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, 0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, 0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, 0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, 0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, 0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, 0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, 0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, 0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, 0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, 0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, 0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, 0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, 0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, 0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, 0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, 0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, 0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, 0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, 0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, 0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, 0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, 0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, 0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, 0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, 0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL, 0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, 0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL, 0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, 0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, 0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, 0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, 0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, 0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, 0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, 0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, 0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, 0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, 0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, 0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, 0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, 0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, 0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, 0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, 0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, 0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, 0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, 0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, 0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, 0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, 0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, 0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, 0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, 0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, 0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, 0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, 0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, 0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, 0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL, 0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, 0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, 0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, 0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, 0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, 0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, 0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, 0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, 0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, 0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL, 0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, 0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, 0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, 0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, 0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, 0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, 0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, 0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, 0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, 0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, 0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, 0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, 0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, 0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, 0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, 0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, 0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, 0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, 0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, 0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, 0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, 0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, 0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL, 0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, 0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, 0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, 0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, 0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL, 0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, 0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, 0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, 0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, 0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, 0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, 0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, 0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, 0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, 0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, 0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, 0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, 0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, 0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, 0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, 0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, 0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, 0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, 0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, 0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, 0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL, 0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, 0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, 0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, 0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, 0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, 0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, 0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, 0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, 0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, 0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, 0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, 0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, 0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, 0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, 0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, 0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, 0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, 0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, 0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, 0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, 0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, 0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
+
+static const double exact_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static void full_multiply(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    hi = uint64_t(r >> 64);
+    lo = uint64_t(r);
+#else
+    uint64_t a_lo = uint32_t(a), a_hi = a >> 32, b_lo = uint32_t(b), b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+    hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    lo = (mid << 32) | uint32_t(ll);
+#endif
+}
+
+static int leading_zeroes(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63)))
+    {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// w * 10^q rounded to nearest even, w != 0 and exact. a 128-bit product is always
+// enough for w below 2^64 (Mushtak & Lemire, "Fast number parsing without fallback").
+static adjusted_mantissa eisel_lemire(int64_t q, uint64_t w)
+{
+    adjusted_mantissa am{0, 0};
+    if (w == 0 || q < POW5_SMALLEST)
+        return am;
+    if (q > POW5_LARGEST)
+    {
+        am.power2 = BINARY_INFINITE_POWER;
+        return am;
+    }
+    int lz = leading_zeroes(w);
+    w <<= lz;
+
+    // only the bits above the rounding position matter, the low word of 5^q is
+    // needed only when they are all ones
+    const uint64_t precision_mask = UINT64_MAX >> (MANTISSA_EXPLICIT_BITS + 3);
+    size_t index = 2 * size_t(q - POW5_SMALLEST);
+    uint64_t hi, lo, hi2, lo2;
+    full_multiply(w, pow5_128[index], hi, lo);
+    if ((hi & precision_mask) == precision_mask)
+    {
+        full_multiply(w, pow5_128[index + 1], hi2, lo2);
+        lo += hi2;
+        if (hi2 > lo)
+            hi++;
+    }
+
+    int upperbit = int(hi >> 63);
+    int shift = upperbit + 64 - MANTISSA_EXPLICIT_BITS - 3;
+    am.mantissa = hi >> shift;
+    // floor(q * log2(10)) + 63
+    am.power2 = int32_t((((152170 + 65536) * q) >> 16) + 63 + upperbit - lz - BINARY_MIN_EXPONENT);
+    if (am.power2 <= 0)
+    {
+        // subnormal, or zero once everything is shifted out
+        if (-am.power2 + 1 >= 64)
+            return adjusted_mantissa{0, 0};
+        am.mantissa >>= -am.power2 + 1;
+        am.mantissa += am.mantissa & 1;
+        am.mantissa >>= 1;
+        am.power2 = am.mantissa < (uint64_t(1) << MANTISSA_EXPLICIT_BITS) ? 0 : 1;
+        return am;
+    }
+    // an exact product sitting halfway rounds to even, only small q can be exact
+    if (lo <= 1 && q >= -4 && q <= 23 && (am.mantissa & 3) == 1 && (am.mantissa << shift) == hi)
+        am.mantissa &= ~uint64_t(1);
+    am.mantissa += am.mantissa & 1;
+    am.mantissa >>= 1;
+    if (am.mantissa >= (uint64_t(2) << MANTISSA_EXPLICIT_BITS))
+    {
+        am.mantissa = uint64_t(1) << MANTISSA_EXPLICIT_BITS;
+        am.power2++;
+    }
+    am.mantissa &= ~(uint64_t(1) << MANTISSA_EXPLICIT_BITS);
+    if (am.power2 >= BINARY_INFINITE_POWER)
+        return adjusted_mantissa{0, BINARY_INFINITE_POWER};
+    return am;
+}
+
+// the exact fallback: all significant digits, shifted by powers of two until the
+// binary exponent and the 53 mantissa bits can be read off (Nigel Tao's algorithm)
+struct big_decimal
+{
+    uint32_t num_digits;
+    int32_t decimal_point;
+    bool truncated;
+    uint8_t digits[DECIMAL_MAX_DIGITS];
+};
+
+static void decimal_trim(big_decimal &d)
+{
+    while (d.num_digits > 0 && d.digits[d.num_digits - 1] == 0)
+        d.num_digits--;
+}
+
+// p..end is a number the grammar already accepted, without the sign
+static void decimal_parse(big_decimal &d, const char *p, const char *end)
+{
+    d.num_digits = 0;
+    d.decimal_point = 0;
+    d.truncated = false;
+    while (p != end && *p == '0')
+        p++;
+    while (p != end && IS_DIGIT09(*p))
+    {
+        if (d.num_digits < DECIMAL_MAX_DIGITS)
+            d.digits[d.num_digits] = uint8_t(*p - '0');
+        else if (*p != '0')
+            d.truncated = true;
+        d.num_digits++;
+        p++;
+    }
+    int32_t int_digits = int32_t(d.num_digits);
+    if (p != end && *p == '.')
+    {
+        p++;
+        if (d.num_digits == 0)
+        {
+            while (p != end && *p == '0')
+            {
+                int_digits--;
+                p++;
+            }
+        }
+        while (p != end && IS_DIGIT09(*p))
+        {
+            if (d.num_digits < DECIMAL_MAX_DIGITS)
+                d.digits[d.num_digits] = uint8_t(*p - '0');
+            else if (*p != '0')
+                d.truncated = true;
+            d.num_digits++;
+            p++;
+        }
+    }
+    d.decimal_point = int_digits;
+    if (d.num_digits > DECIMAL_MAX_DIGITS)
+        d.num_digits = DECIMAL_MAX_DIGITS;
+    decimal_trim(d);
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool neg_exp = false;
+        if (*p == '-' || *p == '+')
+            neg_exp = *p++ == '-';
+        int32_t e = 0;
+        for (; p != end && IS_DIGIT09(*p); p++)
+            if (e < 0x10000)
+                e = e * 10 + (*p - '0');
+        d.decimal_point += neg_exp ? -e : e;
+    }
+}
+
+static void decimal_left_shift(big_decimal &d, uint32_t shift)
+{
+    if (d.num_digits == 0)
+        return;
+    // shift <= 60 adds at most 19 digits
+    uint8_t out[DECIMAL_MAX_DIGITS + 20];
+    size_t w = sizeof(out);
+    uint64_t n = 0;
+    for (int32_t r = int32_t(d.num_digits) - 1; r >= 0; r--)
+    {
+        n += uint64_t(d.digits[r]) << shift;
+        out[--w] = uint8_t(n % 10);
+        n /= 10;
+    }
+    for (; n > 0; n /= 10)
+        out[--w] = uint8_t(n % 10);
+    size_t count = sizeof(out) - w;
+    d.decimal_point += int32_t(count - d.num_digits);
+    if (count > DECIMAL_MAX_DIGITS)
+    {
+        for (size_t i = w + DECIMAL_MAX_DIGITS; i < sizeof(out); i++)
+            if (out[i] != 0)
+                d.truncated = true;
+        count = DECIMAL_MAX_DIGITS;
+    }
+    std::memcpy(d.digits, out + w, count);
+    d.num_digits = uint32_t(count);
+    decimal_trim(d);
+}
+
+static void decimal_right_shift(big_decimal &d, uint32_t shift)
+{
+    uint32_t r = 0, w = 0;
+    uint64_t n = 0;
+    while ((n >> shift) == 0)
+    {
+        if (r < d.num_digits)
+            n = 10 * n + d.digits[r++];
+        else if (n == 0)
+            return;
+        else
+        {
+            while ((n >> shift) == 0)
+            {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+    }
+    d.decimal_point -= int32_t(r - 1);
+    if (d.decimal_point < -DECIMAL_POINT_RANGE)
+    {
+        d.num_digits = 0;
+        d.decimal_point = 0;
+        d.truncated = false;
+        return;
+    }
+    uint64_t mask = (uint64_t(1) << shift) - 1;
+    while (r < d.num_digits)
+    {
+        uint8_t digit = uint8_t(n >> shift);
+        n = 10 * (n & mask) + d.digits[r++];
+        d.digits[w++] = digit;
+    }
+    while (n > 0)
+    {
+        uint8_t digit = uint8_t(n >> shift);
+        n = 10 * (n & mask);
+        if (w < DECIMAL_MAX_DIGITS)
+            d.digits[w++] = digit;
+        else if (digit > 0)
+            d.truncated = true;
+    }
+    d.num_digits = w;
+    decimal_trim(d);
+}
+
+// the integer part, rounded to nearest even
+static uint64_t decimal_round(const big_decimal &d)
+{
+    if (d.num_digits == 0 || d.decimal_point < 0)
+        return 0;
+    if (d.decimal_point > 18)
+        return UINT64_MAX;
+    uint32_t dp = uint32_t(d.decimal_point);
+    uint64_t n = 0;
+    for (uint32_t i = 0; i < dp; i++)
+        n = 10 * n + (i < d.num_digits ? d.digits[i] : 0);
+    bool round_up = false;
+    if (dp < d.num_digits)
+    {
+        round_up = d.digits[dp] >= 5;
+        if (d.digits[dp] == 5 && dp + 1 == d.num_digits)
+            round_up = d.truncated || (dp > 0 && (d.digits[dp - 1] & 1));
+    }
+    return round_up ? n + 1 : n;
+}
+
+static adjusted_mantissa decimal_to_binary(big_decimal &d)
+{
+    static const uint8_t shift_for_power[] = {0, 3, 6, 9, 13, 16, 19, 23, 26, 29, 33, 36, 39, 43, 46, 49, 53, 56, 59};
+    const uint32_t max_shift = 60, num_powers = sizeof(shift_for_power);
+    const adjusted_mantissa zero{0, 0}, infinity{0, BINARY_INFINITE_POWER};
+    if (d.num_digits == 0 || d.decimal_point < -324)
+        return zero;
+    if (d.decimal_point >= 310)
+        return infinity;
+
+    // bring the value into [1/2, 1)
+    int32_t exp2 = 0;
+    while (d.decimal_point > 0)
+    {
+        uint32_t n = uint32_t(d.decimal_point);
+        uint32_t shift = n < num_powers ? shift_for_power[n] : max_shift;
+        decimal_right_shift(d, shift);
+        if (d.decimal_point < -DECIMAL_POINT_RANGE)
+            return zero;
+        exp2 += int32_t(shift);
+    }
+    while (d.decimal_point <= 0)
+    {
+        uint32_t shift;
+        if (d.decimal_point == 0)
+        {
+            if (d.digits[0] >= 5)
+                break;
+            shift = d.digits[0] < 2 ? 2 : 1;
+        }
+        else
+        {
+            uint32_t n = uint32_t(-d.decimal_point);
+            shift = n < num_powers ? shift_for_power[n] : max_shift;
+        }
+        decimal_left_shift(d, shift);
+        if (d.decimal_point > DECIMAL_POINT_RANGE)
+            return infinity;
+        exp2 -= int32_t(shift);
+    }
+    // [1/2, 1) to the [1, 2) of the binary format
+    exp2--;
+    while (BINARY_MIN_EXPONENT + 1 > exp2)
+    {
+        uint32_t n = uint32_t(BINARY_MIN_EXPONENT + 1 - exp2);
+        if (n > max_shift)
+            n = max_shift;
+        decimal_right_shift(d, n);
+        exp2 += int32_t(n);
+    }
+    if (exp2 - BINARY_MIN_EXPONENT >= BINARY_INFINITE_POWER)
+        return infinity;
+
+    decimal_left_shift(d, MANTISSA_EXPLICIT_BITS + 1);
+    uint64_t mantissa = decimal_round(d);
+    if (mantissa >= (uint64_t(1) << (MANTISSA_EXPLICIT_BITS + 1)))
+    {
+        // rounding carried into a new bit
+        decimal_right_shift(d, 1);
+        exp2++;
+        mantissa = decimal_round(d);
+        if (exp2 - BINARY_MIN_EXPONENT >= BINARY_INFINITE_POWER)
+            return infinity;
+    }
+    adjusted_mantissa am;
+    am.power2 = exp2 - BINARY_MIN_EXPONENT;
+    if (mantissa < (uint64_t(1) << MANTISSA_EXPLICIT_BITS))
+        am.power2--;
+    am.mantissa = mantissa & ((uint64_t(1) << MANTISSA_EXPLICIT_BITS) - 1);
+    return am;
+}
+
+// mantissa * 10^exp10 with the sign applied. truncated means digits past the first
+// 19 were dropped from mantissa, first..last is the whole number text for the fallback.
+static double decimal_to_double(bool negative, uint64_t mantissa, int64_t exp10, bool truncated,
+                                const char *first, const char *last)
+{
+    double value;
+    if (!truncated && mantissa <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22)
+    {
+        // both operands are exact, so is the single rounding of the result
+        value = double(mantissa);
+        value = exp10 < 0 ? value / exact_pow10[-exp10] : value * exact_pow10[exp10];
+        return negative ? -value : value;
+    }
+    adjusted_mantissa am = eisel_lemire(exp10, mantissa);
+    // the true significand lies between mantissa and mantissa + 1
+    if (truncated && !(am == eisel_lemire(exp10, mantissa + 1)))
+    {
+        big_decimal d;
+        decimal_parse(d, first, last);
+        am = decimal_to_binary(d);
+    }
+    uint64_t bits = am.mantissa | (uint64_t(am.power2) << MANTISSA_EXPLICIT_BITS) | (uint64_t(negative) << 63);
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// truncating casts that saturate at the ends of the target range, NaN gives 0
+static int64_t double_to_int64(double d)
+{
+    if (d != d)
+        return 0;
+    if (d <= -9223372036854775808.0)
+        return INT64_MIN;
+    if (d >= 9223372036854775808.0)
+        return INT64_MAX;
+    return int64_t(d);
+}
+
+static uint64_t double_to_uint64(double d)
+{
+    if (!(d > 0))
+        return 0;
+    if (d >= 18446744073709551616.0)
+        return UINT64_MAX;
+    return uint64_t(d);
+}
+
+#pragma endregion
+
 namespace kkjson
 {
     using std::move, std::forward;
@@ -58,19 +1076,37 @@ namespace kkjson
     Value &Value::operator=(const Value &another)
     {
         clear();
+        // copies never share arena memory, only borrowed input
         switch (another.type)
         {
         case ValueType::Object:
             pobject = new object_type(*(another.pobject));
             break;
         case ValueType::String:
-            pstring = new string_type(*(another.pstring));
+            if (another.storage == Storage::Borrowed)
+            {
+                pview = another.pview;
+                view_size = another.view_size;
+                storage = Storage::Borrowed;
+            }
+            else if (another.storage == Storage::Inline)
+            {
+                std::memcpy(small_data(), another.small_data(), another.small_size);
+                small_size = another.small_size;
+                storage = Storage::Inline;
+            }
+            else if (another.storage == Storage::Arena)
+                pstring = new string_type(another.pview, another.view_size);
+            else
+                pstring = new string_type(*(another.pstring));
             break;
         case ValueType::Array:
             parray = new array_type(*(another.parray));
             break;
         case ValueType::Number:
-            number_val = another.number_val;
+            // the bits of whichever representation is in use
+            uint_val = another.uint_val;
+            number_kind = another.number_kind;
             break;
         case ValueType::Bool:
             bool_val = another.bool_val;
@@ -97,11 +1133,16 @@ namespace kkjson
             another.parray = nullptr;
             break;
         case ValueType::String:
+            // all the bytes an inline string may use
             pstring = another.pstring;
+            view_size = another.view_size;
+            small_size = another.small_size;
             another.pstring = nullptr;
             break;
         case ValueType::Number:
-            number_val = another.number_val;
+            // the bits of whichever representation is in use
+            uint_val = another.uint_val;
+            number_kind = another.number_kind;
             break;
         case ValueType::Bool:
             bool_val = another.bool_val;
@@ -111,6 +1152,9 @@ namespace kkjson
             break;
         }
         type = another.type;
+        storage = another.storage;
+        another.type = ValueType::None;
+        another.storage = Storage::Heap;
         return *this;
     }
 
@@ -123,7 +1167,9 @@ namespace kkjson
         case ValueType::Object:
             return pobject->size();
         case ValueType::String:
-            return pstring->size();
+            if (storage == Storage::Inline)
+                return small_size;
+            return storage == Storage::Heap ? pstring->size() : view_size;
         case ValueType::Array:
             return parray->size();
         case ValueType::Number:
@@ -143,6 +1189,17 @@ namespace kkjson
 
     bool Value::is_number() const { return (type == ValueType::Number); }
 
+    bool Value::is_int64() const
+    {
+        return type == ValueType::Number && number_kind == NumberKind::Int64;
+    }
+
+    bool Value::is_uint64() const
+    {
+        return type == ValueType::Number &&
+               (number_kind == NumberKind::Uint64 || (number_kind == NumberKind::Int64 && int_val >= 0));
+    }
+
     bool Value::is_string() const { return (type == ValueType::String); }
 
     bool Value::is_array() const { return (type == ValueType::Array); }
@@ -151,18 +1208,78 @@ namespace kkjson
 
     Value::bool_type &Value::as_bool() { return bool_val; }
 
-    Value::number_type &Value::as_number() { return number_val; }
+    Value::bool_type Value::as_bool() const { return bool_val; }
 
-    Value::string_type &Value::as_string() { return *pstring; }
+    Value::number_type Value::as_number() const
+    {
+        switch (number_kind)
+        {
+        case NumberKind::Int64:
+            return number_type(int_val);
+        case NumberKind::Uint64:
+            return number_type(uint_val);
+        case NumberKind::Double:
+        default:
+            return number_val;
+        }
+    }
 
-    Value &Value::operator[](const string_type &k)
+    Value::int64_type Value::as_int64() const
     {
-        auto iter = pobject->find(k);
-        if (iter == pobject->end())
+        switch (number_kind)
         {
-            iter = pobject->insert(pair_type(k, Value())).first;
+        case NumberKind::Int64:
+            return int_val;
+        case NumberKind::Uint64:
+            return uint_val > uint64_type(INT64_MAX) ? INT64_MAX : int64_type(uint_val);
+        case NumberKind::Double:
+        default:
+            return double_to_int64(number_val);
+        }
+    }
+
+    Value::uint64_type Value::as_uint64() const
+    {
+        switch (number_kind)
+        {
+        case NumberKind::Int64:
+            return int_val < 0 ? 0 : uint64_type(int_val);
+        case NumberKind::Uint64:
+            return uint_val;
+        case NumberKind::Double:
+        default:
+            return double_to_uint64(number_val);
+        }
+    }
+
+    Value::string_type &Value::as_string()
+    {
+        if (storage == Storage::Inline)
+        {
+            string_type *owned = new string_type(small_data(), small_size);
+            pstring = owned;
+            storage = Storage::Heap;
         }
-        return iter->second;
+        else if (storage != Storage::Heap)
+        {
+            pstring = new string_type(pview, view_size);
+            storage = Storage::Heap;
+        }
+        return *pstring;
+    }
+
+    std::string_view Value::as_string_view() const
+    {
+        if (storage == Storage::Inline)
+            return std::string_view(small_data(), small_size);
+        if (storage != Storage::Heap)
+            return std::string_view(pview, view_size);
+        return *pstring;
+    }
+
+    Value &Value::operator[](const string_type &k)
+    {
+        return pobject->insert(k, Value());
     }
 
     Value &Value::operator[](size_t idx)
@@ -170,6 +1287,18 @@ namespace kkjson
         return parray->operator[](idx);
     }
 
+    const Value &Value::operator[](const string_type &k) const
+    {
+        static const Value none;
+        auto v = pobject->find(k);
+        return v != nullptr ? *v : none;
+    }
+
+    const Value &Value::operator[](size_t idx) const
+    {
+        return parray->operator[](idx);
+    }
+
     Value &Value::operator=(bool_type v)
     {
         set_bool(v);
@@ -182,6 +1311,18 @@ namespace kkjson
         return *this;
     }
 
+    Value &Value::operator=(int64_type n)
+    {
+        set_int64(n);
+        return *this;
+    }
+
+    Value &Value::operator=(uint64_type n)
+    {
+        set_uint64(n);
+        return *this;
+    }
+
     Value &Value::operator=(const string_type &s)
     {
         set_string(s);
@@ -204,16 +1345,24 @@ namespace kkjson
 
     Value::Value(number_type n) { set_number(n); }
 
+    Value::Value(int64_type n) { set_int64(n); }
+
+    Value::Value(uint64_type n) { set_uint64(n); }
+
     Value::Value(const string_type &s) { set_string(s); }
 
     Value::Value(const init_array_type &l) { set_array(l); }
 
     Value::Value(const init_obj_type &l) { set_object(l); }
 
-    Value::array_iterator Value::array_begin() { return array_iterator(parray->begin()); }
-    Value::array_iterator Value::array_end() { return array_iterator(parray->end()); }
+    Value::array_iterator Value::array_begin() { return array_iterator(parray->data()); }
+    Value::array_iterator Value::array_end() { return array_iterator(parray->data() + parray->size()); }
+    Value::const_array_iterator Value::array_begin() const { return const_array_iterator(parray->data()); }
+    Value::const_array_iterator Value::array_end() const { return const_array_iterator(parray->data() + parray->size()); }
     Value::object_iterator Value::object_begin() { return object_iterator(pobject->begin()); }
     Value::object_iterator Value::object_end() { return object_iterator(pobject->end()); }
+    Value::const_object_iterator Value::object_begin() const { return const_object_iterator(pobject->begin()); }
+    Value::const_object_iterator Value::object_end() const { return const_object_iterator(pobject->end()); }
 
     void Value::set_literal(ValueType t)
     {
@@ -232,11 +1381,38 @@ namespace kkjson
     {
         clear();
         type = ValueType::Number;
+        number_kind = NumberKind::Double;
         number_val = n;
     }
 
+    void Value::set_int64(int64_type n)
+    {
+        clear();
+        type = ValueType::Number;
+        number_kind = NumberKind::Int64;
+        int_val = n;
+    }
+
+    void Value::set_uint64(uint64_type n)
+    {
+        if (n <= uint64_type(INT64_MAX))
+        {
+            set_int64(int64_type(n));
+            return;
+        }
+        clear();
+        type = ValueType::Number;
+        number_kind = NumberKind::Uint64;
+        uint_val = n;
+    }
+
     void Value::set_string(const string_type &another)
     {
+        if (another.size() <= SMALL_STRING_MAX)
+        {
+            set_small_string(another.data(), another.size());
+            return;
+        }
         clear();
         type = ValueType::String;
         pstring = new string_type(another);
@@ -244,33 +1420,97 @@ namespace kkjson
 
     void Value::set_string(const char *p, size_t n)
     {
+        if (n <= SMALL_STRING_MAX)
+        {
+            set_small_string(p, n);
+            return;
+        }
         clear();
         type = ValueType::String;
         pstring = new string_type(p, n);
     }
 
-    void Value::set_array(const init_array_type &list)
+    void Value::set_small_string(const char *p, size_t n)
     {
         clear();
-        type = ValueType::Array;
-        parray = new array_type(list);
+        type = ValueType::String;
+        storage = Storage::Inline;
+        small_size = uint8_t(n);
+        std::memcpy(small_data(), p, n);
     }
 
-    void Value::set_object(const init_obj_type &list)
+    // the inline bytes span view_size and the union, which follow each other
+    char *Value::small_data()
     {
-        clear();
-        type = ValueType::Object;
-        pobject = new object_type(list);
+        static_assert(offsetof(Value, view_size) + SMALL_STRING_MAX <= sizeof(Value), "no room for inline strings");
+        return reinterpret_cast<char *>(this) + offsetof(Value, view_size);
     }
 
-    void Value::init_array()
+    const char *Value::small_data() const
     {
-        clear();
-        type = ValueType::Array;
-        parray = new array_type;
+        return reinterpret_cast<const char *>(this) + offsetof(Value, view_size);
     }
 
-    void Value::array_push_back(const Value &e)
+    void Value::set_string_view(const char *p, size_t n)
+    {
+        if (n > UINT32_MAX)
+        {
+            set_string(p, n);
+            return;
+        }
+        clear();
+        type = ValueType::String;
+        storage = Storage::Borrowed;
+        pview = p;
+        view_size = uint32_t(n);
+    }
+
+    void Value::set_string(const char *p, size_t n, std::pmr::memory_resource *arena)
+    {
+        if (n > UINT32_MAX || n <= SMALL_STRING_MAX)
+        {
+            set_string(p, n);
+            return;
+        }
+        clear();
+        type = ValueType::String;
+        storage = Storage::Arena;
+        char *buf = (char *)arena->allocate(n, 1);
+        std::memcpy(buf, p, n);
+        pview = buf;
+        view_size = uint32_t(n);
+    }
+
+    void Value::set_array(const init_array_type &list)
+    {
+        clear();
+        type = ValueType::Array;
+        parray = new array_type(list);
+    }
+
+    void Value::set_object(const init_obj_type &list)
+    {
+        clear();
+        type = ValueType::Object;
+        pobject = new object_type;
+        for (auto &e : list)
+            pobject->insert(e.first, Value(e.second));
+    }
+
+    void Value::init_array(std::pmr::memory_resource *arena)
+    {
+        clear();
+        type = ValueType::Array;
+        if (arena == nullptr)
+            parray = new array_type;
+        else
+        {
+            parray = new (arena->allocate(sizeof(array_type), alignof(array_type))) array_type(arena);
+            storage = Storage::Arena;
+        }
+    }
+
+    void Value::array_push_back(const Value &e)
     {
         if (type == ValueType::Array && parray != nullptr)
         {
@@ -286,18 +1526,24 @@ namespace kkjson
         }
     }
 
-    void Value::init_object()
+    void Value::init_object(std::pmr::memory_resource *arena, StringPool *pool)
     {
         clear();
         type = ValueType::Object;
-        pobject = new object_type;
+        if (arena == nullptr)
+            pobject = new object_type(nullptr, pool);
+        else
+        {
+            pobject = new (arena->allocate(sizeof(object_type), alignof(object_type))) object_type(arena, pool);
+            storage = Storage::Arena;
+        }
     }
 
     void Value::object_insert(const string_type &k, const Value &v)
     {
         if (type == ValueType::Object && pobject != nullptr)
         {
-            pobject->insert(pair_type(k, v));
+            pobject->insert(k, Value(v));
         }
     }
 
@@ -305,30 +1551,39 @@ namespace kkjson
     {
         if (type == ValueType::Object && pobject != nullptr)
         {
-            pobject->insert(pair_type(k, forward<Value>(v)));
+            pobject->insert(k, forward<Value>(v));
+        }
+    }
+
+    void Value::object_insert(std::string_view k, Value &&v, bool borrow_key)
+    {
+        if (type == ValueType::Object && pobject != nullptr)
+        {
+            pobject->insert(k, forward<Value>(v), borrow_key);
         }
     }
 
     void Value::clear()
     {
+        // arena containers are not destroyed, their children included
         switch (type)
         {
         case ValueType::Object:
-            if (pobject != nullptr)
+            if (storage == Storage::Heap && pobject != nullptr)
             {
                 delete pobject;
                 pobject = nullptr;
             }
             break;
         case ValueType::Array:
-            if (parray != nullptr)
+            if (storage == Storage::Heap && parray != nullptr)
             {
                 delete parray;
                 pobject = nullptr;
             }
             break;
         case ValueType::String:
-            if (pstring != nullptr)
+            if (storage == Storage::Heap && pstring != nullptr)
             {
                 delete pstring;
                 pstring = nullptr;
@@ -336,6 +1591,7 @@ namespace kkjson
             break;
         case ValueType::Number:
             number_val = 0;
+            number_kind = NumberKind::Double;
         case ValueType::Bool:
         case ValueType::Null:
         case ValueType::None:
@@ -343,131 +1599,291 @@ namespace kkjson
             break;
         }
         type = ValueType::None;
+        storage = Storage::Heap;
+    }
+
+#pragma endregion
+
+#pragma region object storage
+
+    __object::__object(std::pmr::memory_resource *arena, StringPool *pool)
+        : members(arena != nullptr ? arena : std::pmr::get_default_resource()),
+          index(members.get_allocator()), pool(pool), owns_keys(arena == nullptr && pool == nullptr) {}
+
+    __object::__object(const __object &another) : pool(nullptr), owns_keys(true)
+    {
+        members.reserve(another.members.size());
+        for (auto &m : another.members)
+            members.emplace_back(std::string_view(copy_key(m.first), m.first.size()), m.second);
+        if (!another.index.empty())
+            build_index();
+    }
+
+    __object::~__object()
+    {
+        if (!owns_keys)
+            return;
+        auto res = members.get_allocator().resource();
+        for (auto &m : members)
+        {
+            if (!m.first.empty())
+                res->deallocate((void *)m.first.data(), m.first.size(), 1);
+        }
+    }
+
+    const char *__object::copy_key(std::string_view k)
+    {
+        if (k.empty())
+            return "";
+        char *p = (char *)members.get_allocator().resource()->allocate(k.size(), 1);
+        std::memcpy(p, k.data(), k.size());
+        return p;
+    }
+
+    void __object::build_index()
+    {
+        size_t cap = OBJECT_INDEX_MIN_CAP;
+        while (cap < members.size() * 2)
+            cap <<= 1;
+        index.assign(cap, 0);
+        for (size_t pos = 0; pos < members.size(); pos++)
+            index_insert(pos);
+    }
+
+    void __object::index_insert(size_t pos)
+    {
+        size_t mask = index.size() - 1;
+        size_t slot = std::hash<std::string_view>()(members[pos].first) & mask;
+        while (index[slot] != 0)
+            slot = (slot + 1) & mask;
+        index[slot] = uint32_t(pos + 1);
+    }
+
+    Value::member_type *__object::find_member(std::string_view k) const
+    {
+        auto self = const_cast<__object *>(this);
+        if (index.empty())
+        {
+            for (auto &m : self->members)
+            {
+                // interned keys match by address, a shorter view of the same bytes does not
+                if ((m.first.data() == k.data() && m.first.size() == k.size()) || m.first == k)
+                    return &m;
+            }
+            return nullptr;
+        }
+        size_t mask = index.size() - 1;
+        for (size_t slot = std::hash<std::string_view>()(k) & mask; index[slot] != 0; slot = (slot + 1) & mask)
+        {
+            auto &m = self->members[index[slot] - 1];
+            if (m.first == k)
+                return &m;
+        }
+        return nullptr;
+    }
+
+    size_t __object::size() const { return members.size(); }
+    Value::member_type *__object::begin() { return members.data(); }
+    Value::member_type *__object::end() { return members.data() + members.size(); }
+    const Value::member_type *__object::begin() const { return members.data(); }
+    const Value::member_type *__object::end() const { return members.data() + members.size(); }
+
+    Value *__object::find(std::string_view k)
+    {
+        auto m = find_member(k);
+        return m != nullptr ? &m->second : nullptr;
+    }
+
+    const Value *__object::find(std::string_view k) const
+    {
+        auto m = find_member(k);
+        return m != nullptr ? &m->second : nullptr;
+    }
+
+    Value &__object::insert(std::string_view k, Value &&v, bool borrow_key)
+    {
+        if (pool != nullptr)
+        {
+            k = pool->intern(k);
+            borrow_key = true;
+        }
+        if (auto m = find_member(k))
+            return m->second;
+        members.emplace_back(std::string_view(borrow_key ? k.data() : copy_key(k), k.size()), forward<Value>(v));
+        // the index is built once, when the object outgrows the linear scan
+        if (!index.empty())
+        {
+            if (members.size() * 2 > index.size())
+                build_index();
+            else
+                index_insert(members.size() - 1);
+        }
+        else if (members.size() > OBJECT_INDEX_THRESHOLD)
+            build_index();
+        return members.back().second;
     }
 
 #pragma endregion
 
 #pragma region iterator related
 
-    __array_iterator::__array_iterator() = default;
-    __array_iterator::__array_iterator(const self_type &another) : it(another.it) {}
-    __array_iterator::__array_iterator(self_type &&another) : it(move(another.it)) {}
-    __array_iterator::__array_iterator(const inner_iter_type &a_it) : it(a_it) {}
-    __array_iterator::__array_iterator(inner_iter_type &&a_it) : it(forward<inner_iter_type>(a_it)) {}
-    __array_iterator::~__array_iterator() = default;
+    template <class T>
+    __array_iterator<T>::__array_iterator() : it(nullptr) {}
+    template <class T>
+    __array_iterator<T>::__array_iterator(const self_type &another) : it(another.it) {}
+    template <class T>
+    __array_iterator<T>::__array_iterator(pointer a_it) : it(a_it) {}
+    template <class T>
+    __array_iterator<T>::~__array_iterator() = default;
 
-    __array_iterator::reference __array_iterator::operator*() const { return *it; }
-    __array_iterator::pointer __array_iterator::operator->() const { return it.operator->(); }
-    __array_iterator::difference_type __array_iterator::operator-(const self_type &another) const { return it - another.it; }
+    template <class T>
+    typename __array_iterator<T>::reference __array_iterator<T>::operator*() const { return *it; }
+    template <class T>
+    typename __array_iterator<T>::pointer __array_iterator<T>::operator->() const { return it; }
+    template <class T>
+    typename __array_iterator<T>::difference_type __array_iterator<T>::operator-(const self_type &another) const { return it - another.it; }
 
-    __array_iterator::self_type &__array_iterator::operator++()
+    template <class T>
+    typename __array_iterator<T>::self_type &__array_iterator<T>::operator++()
     {
         ++it;
         return *this;
     }
 
-    __array_iterator::self_type __array_iterator::operator++(int)
+    template <class T>
+    typename __array_iterator<T>::self_type __array_iterator<T>::operator++(int)
     {
         self_type tmp(*this);
         ++it;
         return tmp;
     }
 
-    __array_iterator::self_type &__array_iterator::operator+=(difference_type n)
+    template <class T>
+    typename __array_iterator<T>::self_type &__array_iterator<T>::operator+=(difference_type n)
     {
         it += n;
         return *this;
     }
 
-    __array_iterator::self_type __array_iterator::operator+(difference_type n) const
+    template <class T>
+    typename __array_iterator<T>::self_type __array_iterator<T>::operator+(difference_type n) const
     {
         self_type tmp(*this);
         tmp += n;
         return tmp;
     }
 
-    __array_iterator::self_type &__array_iterator::operator--()
+    template <class T>
+    typename __array_iterator<T>::self_type &__array_iterator<T>::operator--()
     {
         --it;
         return *this;
     }
-    __array_iterator::self_type __array_iterator::operator--(int)
+
+    template <class T>
+    typename __array_iterator<T>::self_type __array_iterator<T>::operator--(int)
     {
         self_type tmp(*this);
         --it;
         return tmp;
     }
 
-    __array_iterator::self_type &__array_iterator::operator-=(difference_type n)
+    template <class T>
+    typename __array_iterator<T>::self_type &__array_iterator<T>::operator-=(difference_type n)
     {
         it -= n;
         return *this;
     }
 
-    __array_iterator::self_type __array_iterator::operator-(difference_type n) const
+    template <class T>
+    typename __array_iterator<T>::self_type __array_iterator<T>::operator-(difference_type n) const
     {
         self_type tmp(*this);
         tmp -= n;
         return tmp;
     }
 
-    __array_iterator::reference __array_iterator::operator[](difference_type n) const { return it[n]; }
-    bool __array_iterator::operator==(const self_type &another) const { return it == another.it; }
-    bool __array_iterator::operator!=(const self_type &another) const { return it != another.it; }
-    bool __array_iterator::operator<(const self_type &another) const { return it < another.it; }
-    bool __array_iterator::operator>(const self_type &another) const { return it > another.it; }
-    bool __array_iterator::operator<=(const self_type &another) const { return it <= another.it; }
-    bool __array_iterator::operator>=(const self_type &another) const { return it >= another.it; }
+    template <class T>
+    typename __array_iterator<T>::reference __array_iterator<T>::operator[](difference_type n) const { return it[n]; }
+    template <class T>
+    bool __array_iterator<T>::operator==(const self_type &another) const { return it == another.it; }
+    template <class T>
+    bool __array_iterator<T>::operator!=(const self_type &another) const { return it != another.it; }
+    template <class T>
+    bool __array_iterator<T>::operator<(const self_type &another) const { return it < another.it; }
+    template <class T>
+    bool __array_iterator<T>::operator>(const self_type &another) const { return it > another.it; }
+    template <class T>
+    bool __array_iterator<T>::operator<=(const self_type &another) const { return it <= another.it; }
+    template <class T>
+    bool __array_iterator<T>::operator>=(const self_type &another) const { return it >= another.it; }
+
+    template class __array_iterator<Value>;
+    template class __array_iterator<const Value>;
 
 
-    __object_iterator::__object_iterator() = default;
-    __object_iterator::__object_iterator(const self_type &another) : it(another.it) {}
-    __object_iterator::__object_iterator(self_type &&another) : it(move(another.it)) {}
-    __object_iterator::__object_iterator(const inner_iter_type &a_it) : it(a_it) {}
-    __object_iterator::__object_iterator(inner_iter_type &&a_it) : it(forward<inner_iter_type>(a_it)) {}
-    __object_iterator::~__object_iterator() = default;
+    template <class T>
+    __object_iterator<T>::__object_iterator() : it(nullptr) {}
+    template <class T>
+    __object_iterator<T>::__object_iterator(const self_type &another) : it(another.it) {}
+    template <class T>
+    __object_iterator<T>::__object_iterator(pointer a_it) : it(a_it) {}
+    template <class T>
+    __object_iterator<T>::~__object_iterator() = default;
 
-    __object_iterator::reference __object_iterator::operator*() const { return *it; }
-    __object_iterator::pointer __object_iterator::operator->() const { return it.operator->(); }
+    template <class T>
+    typename __object_iterator<T>::reference __object_iterator<T>::operator*() const { return *it; }
+    template <class T>
+    typename __object_iterator<T>::pointer __object_iterator<T>::operator->() const { return it; }
 
-    __object_iterator::self_type &__object_iterator::operator++()
+    template <class T>
+    typename __object_iterator<T>::self_type &__object_iterator<T>::operator++()
     {
         ++it;
         return *this;
     }
 
-    __object_iterator::self_type __object_iterator::operator++(int)
+    template <class T>
+    typename __object_iterator<T>::self_type __object_iterator<T>::operator++(int)
     {
         self_type tmp(*this);
         ++it;
         return tmp;
     }
 
-    __object_iterator::self_type &__object_iterator::operator--()
+    template <class T>
+    typename __object_iterator<T>::self_type &__object_iterator<T>::operator--()
     {
         --it;
         return *this;
     }
 
-    __object_iterator::self_type __object_iterator::operator--(int)
+    template <class T>
+    typename __object_iterator<T>::self_type __object_iterator<T>::operator--(int)
     {
         self_type tmp(*this);
         --it;
         return tmp;
     }
 
-    bool __object_iterator::operator==(const self_type &another) const { return it == another.it; }
-    bool __object_iterator::operator!=(const self_type &another) const { return it != another.it; }
+    template <class T>
+    bool __object_iterator<T>::operator==(const self_type &another) const { return it == another.it; }
+    template <class T>
+    bool __object_iterator<T>::operator!=(const self_type &another) const { return it != another.it; }
+
+    template class __object_iterator<Value::member_type>;
+    template class __object_iterator<const Value::member_type>;
 
 #pragma endregion
 
 #pragma region char_stack
 
+    // nothing is allocated until the first push, most documents never decode a string
     __char_stack::__char_stack()
     {
         top = 0;
-        capability = CHAR_STACK_INIT_CAP;
-        ptr = (char *)std::malloc(CHAR_STACK_INIT_CAP);
+        capability = 0;
+        ptr = nullptr;
     }
 
     __char_stack::~__char_stack()
@@ -483,9 +1899,10 @@ namespace kkjson
         void *ret;
         if (top + size >= capability)
         {
-            do
+            if (capability == 0)
+                capability = CHAR_STACK_INIT_CAP;
+            while (top + size >= capability)
                 EXTEND_SIZE(capability);
-            while (top + size >= capability);
             ptr = (char *)std::realloc(ptr, capability);
         }
         ret = ptr + top;
@@ -509,20 +1926,45 @@ namespace kkjson
         top = n;
     }
 
+    size_t __char_stack::get_capacity() const
+    {
+        return capability;
+    }
+
+    void __char_stack::shrink()
+    {
+        std::free(ptr);
+        ptr = nullptr;
+        capability = 0;
+        top = 0;
+    }
+
 #pragma endregion
 
 #pragma region __parser
 
-    __parser::__parser(const char *cstr) : raw_iter(cstr) {}
+    __parser::__parser(const char *data, size_t len, const ParseOptions &opts, std::pmr::memory_resource *arena)
+        : raw_begin(data), raw_iter(data), raw_end(data + len), opts(opts), arena(arena), nesting(0) {}
 
     ParseStatus __parser::exec(Value &out)
+    {
+        // the parts of an array are built on the heap, an arena serves one thread only
+        if (opts.threads != 1 && arena == nullptr && size_t(raw_end - raw_iter) >= 2 * PARALLEL_MIN_PART)
+            return exec_parallel(out);
+        // the index stores 32-bit offsets
+        if (opts.structural_index && size_t(raw_end - raw_iter) <= UINT32_MAX)
+            return exec_indexed(out);
+        return exec_serial(out);
+    }
+
+    ParseStatus __parser::exec_serial(Value &out)
     {
         ParseStatus ret;
         parse_whitespace();
         if ((ret = parse_value(out)) == ParseStatus::OK)
         {
             parse_whitespace();
-            if (!IS_ZEROEND(*raw_iter))
+            if (raw_iter != raw_end)
             {
                 ret = ParseStatus::ROOT_NOT_SINGULAR;
             }
@@ -532,48 +1974,151 @@ namespace kkjson
 
     ParseStatus __parser::parse_whitespace()
     {
-        while (IS_WHITESPACE(*raw_iter))
-            raw_iter++;
+        // separators are mostly followed by nothing or a single space, only go wide for longer runs
+        if (raw_iter == raw_end || !IS_WHITESPACE(*raw_iter))
+            return ParseStatus::OK;
+        raw_iter++;
+        if (raw_iter == raw_end || !IS_WHITESPACE(*raw_iter))
+            return ParseStatus::OK;
+        raw_iter = skip_whitespace(raw_iter, raw_end, opts.padded);
         return ParseStatus::OK;
     }
 
+    // open containers wait on frames instead of the call stack, only max_depth bounds the nesting
     ParseStatus __parser::parse_value(Value &out)
     {
-        ParseStatus status;
+        if (PEEK_AT(raw_iter, raw_end) != '[' && PEEK_AT(raw_iter, raw_end) != '{')
+            return parse_scalar(out);
+        size_t base = frames.size(), top = cstack.get_top();
+        ParseStatus ret = ParseStatus::OK;
+        Value done;
+        while (ret == ParseStatus::OK)
+        {
+            // descend until a value is complete, a scalar or an empty container
+            char open = PEEK_AT(raw_iter, raw_end);
+            if (open == '[' || open == '{')
+            {
+                if (nesting + (frames.size() - base) >= opts.max_depth)
+                {
+                    ret = ParseStatus::DEPTH_EXCEEDED;
+                    break;
+                }
+                raw_iter++;
+                frames.push_back(__parse_frame{Value(), nullptr, 0});
+                if (open == '[')
+                    frames.back().container.init_array(arena);
+                else
+                    frames.back().container.init_object(arena, opts.intern);
+                parse_whitespace();
+                if (PEEK_AT(raw_iter, raw_end) != (open == '[' ? ']' : '}'))
+                {
+                    if (open == '{')
+                        ret = parse_key();
+                    continue;
+                }
+                raw_iter++;
+                done = move(frames.back().container);
+                frames.pop_back();
+            }
+            else if ((ret = parse_scalar(done)) != ParseStatus::OK)
+                break;
+            // ascend, closing every container that ends after it
+            while (frames.size() != base)
+            {
+                __parse_frame &f = frames.back();
+                bool is_array = f.container.get_type() == ValueType::Array;
+                if (is_array)
+                    f.container.array_push_back(move(done));
+                else
+                {
+                    // a decoded key may have moved with cstack while the value was parsed.
+                    // keys of arena objects can point into the input like their strings.
+                    bool borrow_key = f.key != nullptr && arena != nullptr && opts.borrow_strings;
+                    const char *key = f.key != nullptr ? f.key : (char *)cstack.pop(f.key_size);
+                    f.container.object_insert(std::string_view(key, f.key_size), move(done), borrow_key);
+                }
+                parse_whitespace();
+                if (PEEK_AT(raw_iter, raw_end) == ',')
+                {
+                    raw_iter++;
+                    parse_whitespace();
+                    if (!is_array)
+                        ret = parse_key();
+                    break;
+                }
+                if (PEEK_AT(raw_iter, raw_end) != (is_array ? ']' : '}'))
+                {
+                    ret = is_array ? ParseStatus::MISS_ARRAY_SYMBOL : ParseStatus::MISS_OBJECT_SYMBOL;
+                    break;
+                }
+                raw_iter++;
+                done = move(f.container);
+                frames.pop_back();
+            }
+            if (ret == ParseStatus::OK && frames.size() == base)
+            {
+                out = move(done);
+                return ParseStatus::OK;
+            }
+        }
+        frames.erase(frames.begin() + base, frames.end());
+        cstack.set_top(top);
+        return ret;
+    }
+
+    ParseStatus __parser::parse_scalar(Value &out)
+    {
+        if (raw_iter == raw_end)
+            return ParseStatus::UNEXPECTED_SYMBOL;
         switch (*raw_iter)
         {
         case 't':
-            status = parse_bool(out, "true", true);
-            break;
+            return parse_bool(out, "true", true);
         case 'f':
-            status = parse_bool(out, "false", false);
-            break;
+            return parse_bool(out, "false", false);
         case 'n':
-            status = parse_literal(out, "null", ValueType::Null);
-            break;
+            return parse_literal(out, "null", ValueType::Null);
         case '"':
-            status = parse_string(out);
-            break;
-        case '[':
-            status = parse_array(out);
-            break;
-        case '{':
-            status = parse_object(out);
-            break;
-        case '\0':
-            status = ParseStatus::UNEXPECTED_SYMBOL;
-            break;
+            return parse_string(out);
         default:
-            status = parse_number(out);
-            break;
+            return parse_number(out);
         }
-        return status;
+    }
+
+    // reads a member key and its colon into the innermost frame
+    ParseStatus __parser::parse_key()
+    {
+        __parse_frame &f = frames.back();
+        ParseStatus ret;
+        if (PEEK_AT(raw_iter, raw_end) != '"')
+            return ParseStatus::MISS_OBJECT_KEY;
+        if ((ret = parse_string_raw(f.key, f.key_size)) != ParseStatus::OK)
+            return ret;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) != ':')
+            return ParseStatus::MISS_OBJECT_SYMBOL;
+        raw_iter++;
+        parse_whitespace();
+        return ParseStatus::OK;
+    }
+
+    template <class F>
+    ParseStatus __parser::nested(F &&scan)
+    {
+        if (nesting >= opts.max_depth)
+            return ParseStatus::DEPTH_EXCEEDED;
+        nesting++;
+        ParseStatus ret = scan();
+        nesting--;
+        return ret;
     }
 
     ParseStatus __parser::parse_literal(Value &out, const char *target, ValueType t)
     {
-        size_t idx;
-        for (idx = 0; target[idx]; idx++)
+        size_t idx, len = std::strlen(target);
+        if (size_t(raw_end - raw_iter) < len)
+            return ParseStatus::INVALID_VALUE;
+        for (idx = 0; idx < len; idx++)
         {
             if (raw_iter[idx] != target[idx])
                 return ParseStatus::INVALID_VALUE;
@@ -585,8 +2130,10 @@ namespace kkjson
 
     ParseStatus __parser::parse_bool(Value &out, const char *target, bool v)
     {
-        size_t idx;
-        for (idx = 0; target[idx]; idx++)
+        size_t idx, len = std::strlen(target);
+        if (size_t(raw_end - raw_iter) < len)
+            return ParseStatus::INVALID_VALUE;
+        for (idx = 0; idx < len; idx++)
         {
             if (raw_iter[idx] != target[idx])
                 return ParseStatus::INVALID_VALUE;
@@ -598,22 +2145,63 @@ namespace kkjson
 
     ParseStatus __parser::parse_string(Value &out)
     {
+        const char *in_place;
         size_t length;
         ParseStatus ret;
-        if ((ret = parse_string_raw(length)) == ParseStatus::OK)
-            out.set_string((char *)cstack.pop(length), length);
+        if ((ret = parse_string_raw(in_place, length)) == ParseStatus::OK)
+        {
+            // strings that fit inside the value gain nothing from the pool
+            if (opts.intern != nullptr && length > SMALL_STRING_MAX && length <= opts.intern->max_value)
+            {
+                auto s = opts.intern->intern(std::string_view(in_place != nullptr ? in_place : (char *)cstack.pop(length), length));
+                out.set_string_view(s.data(), s.size());
+            }
+            else if (in_place != nullptr && opts.borrow_strings)
+                out.set_string_view(in_place, length);
+            else
+            {
+                const char *p = in_place != nullptr ? in_place : (char *)cstack.pop(length);
+                if (arena != nullptr)
+                    out.set_string(p, length, arena);
+                else
+                    out.set_string(p, length);
+            }
+        }
         return ret;
     }
 
-    ParseStatus __parser::parse_string_raw(size_t &length_out)
+    // escape-free strings are left where they are and returned through in_place,
+    // the others are decoded onto cstack and in_place is set to nullptr.
+    ParseStatus __parser::parse_string_raw(const char *&in_place, size_t &length_out)
     {
         size_t top_bak = cstack.get_top();
         raw_iter++;
-        const char *iter = raw_iter;
+        const char *iter = raw_iter, *run_end;
         char cur;
         unsigned uh, ul;
+
+        run_end = scan_string(iter, raw_end, opts.padded);
+        if (run_end != raw_end && *run_end == '"')
+        {
+            in_place = raw_iter;
+            length_out = run_end - raw_iter;
+            raw_iter = run_end + 1;
+            return ParseStatus::OK;
+        }
+        in_place = nullptr;
         while (true)
         {
+            // copy the clean run up to the next quote, escape or control byte at once
+            if (run_end != iter)
+            {
+                std::memcpy(cstack.push(run_end - iter), iter, run_end - iter);
+                iter = run_end;
+            }
+            if (iter == raw_end)
+            {
+                cstack.set_top(top_bak);
+                return ParseStatus::MISS_QUOTATION_MARK;
+            }
             cur = *iter++;
             switch (cur)
             {
@@ -622,7 +2210,7 @@ namespace kkjson
                 raw_iter = iter;
                 return ParseStatus::OK;
             case '\\':
-                switch (*iter++)
+                switch (iter != raw_end ? *iter++ : '\0')
                 {
                 case '"':
                     PUSH_CHAR(cstack, '"');
@@ -650,7 +2238,7 @@ namespace kkjson
                     break;
                 case 'u':
                     // unicode
-                    if (!hex4_to_ui(iter, uh))
+                    if (raw_end - iter < 4 || !hex4_to_ui(iter, uh))
                     {
                         cstack.set_top(top_bak);
                         return ParseStatus::INVALID_UNICODE_HEX;
@@ -658,17 +2246,17 @@ namespace kkjson
                     iter += 4;
                     if (IS_SURROGATE_H(uh))
                     {
-                        if (*iter++ != '\\')
+                        if (iter == raw_end || *iter++ != '\\')
                         {
                             cstack.set_top(top_bak);
                             return ParseStatus::INVALID_UNICODE_SURROGATE;
                         }
-                        if (*iter++ != 'u')
+                        if (iter == raw_end || *iter++ != 'u')
                         {
                             cstack.set_top(top_bak);
                             return ParseStatus::INVALID_UNICODE_SURROGATE;
                         }
-                        if (!(hex4_to_ui(iter, ul)))
+                        if (raw_end - iter < 4 || !hex4_to_ui(iter, ul))
                         {
                             cstack.set_top(top_bak);
                             return ParseStatus::INVALID_UNICODE_HEX;
@@ -708,172 +2296,2874 @@ namespace kkjson
                     return ParseStatus::INVALID_STRING_ESCAPE;
                 }
                 break;
-            case '\0':
-                cstack.set_top(top_bak);
-                return ParseStatus::MISS_QUOTATION_MARK;
             default:
-                if ((unsigned char)cur < 0x20)
-                {
-                    cstack.set_top(top_bak);
-                    return ParseStatus::INVALID_STRING_CHAR;
-                }
-                PUSH_CHAR(cstack, cur);
+                // scan_string only stops on control bytes otherwise
+                cstack.set_top(top_bak);
+                return ParseStatus::INVALID_STRING_CHAR;
             }
+            run_end = scan_string(iter, raw_end, opts.padded);
         }
     }
 
-    ParseStatus __parser::parse_array(Value &out)
+    ParseStatus __parser::parse_number(Value &out)
     {
-        raw_iter++;
-        out.init_array();
-        ParseStatus ret;
-        parse_whitespace();
-        if (*raw_iter == ']')
+        const char *iter = raw_iter;
+        bool negative = false, truncated = false;
+        // the first 19 significant digits, the value is mantissa * 10^exp10
+        uint64_t mantissa = 0;
+        int64_t exp10 = 0;
+        int sig_digits = 0;
+        if (PEEK_AT(iter, raw_end) == '-')
         {
-            raw_iter++;
-            return ParseStatus::OK;
+            negative = true;
+            iter++;
         }
-        while (true)
+
+        if (PEEK_AT(iter, raw_end) == '0')
         {
-            Value tmp;
-            if ((ret = parse_value(tmp)) != ParseStatus::OK)
-            {
-                break;
-            }
-            out.array_push_back(move(tmp));
-            parse_whitespace();
-            if (*raw_iter == ',')
+            // strtod used to swallow "0123" and "0x1f" whole, keep rejecting them
+            iter++;
+            if (IS_DIGIT09(PEEK_AT(iter, raw_end)) || PEEK_AT(iter, raw_end) == 'x' || PEEK_AT(iter, raw_end) == 'X')
+                return ParseStatus::INVALID_VALUE;
+        }
+        else
+        {
+            if (!IS_DIGIT19(PEEK_AT(iter, raw_end)))
+                return ParseStatus::INVALID_VALUE;
+            do
             {
-                raw_iter++;
-                parse_whitespace();
-            }
-            else if (*raw_iter == ']')
+                if (sig_digits < MANTISSA_MAX_DIGITS)
+                {
+                    mantissa = mantissa * 10 + (*iter - '0');
+                    sig_digits++;
+                }
+                else
+                {
+                    truncated |= *iter != '0';
+                    exp10++;
+                }
+                iter++;
+            } while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
+        }
+
+        // integer tokens that fit 64 bits skip the floating-point conversion, -0 stays a double
+        if (PEEK_AT(iter, raw_end) != '.' && PEEK_AT(iter, raw_end) != 'e' && PEEK_AT(iter, raw_end) != 'E')
+        {
+            unsigned last = iter[-1] - '0';
+            if (negative && exp10 == 0 && mantissa != 0 && mantissa <= uint64_t(1) << 63)
             {
-                raw_iter++;
+                out.set_int64(int64_t(0 - mantissa));
+                raw_iter = iter;
                 return ParseStatus::OK;
             }
-            else
+            if (!negative && (exp10 == 0 || (exp10 == 1 && mantissa <= (UINT64_MAX - last) / 10)))
             {
-                ret = ParseStatus::MISS_ARRAY_SYMBOL;
-                break;
+                out.set_uint64(exp10 == 0 ? mantissa : mantissa * 10 + last);
+                raw_iter = iter;
+                return ParseStatus::OK;
             }
         }
-        out.set_literal(ValueType::None);
-        return ret;
-    }
 
-    ParseStatus __parser::parse_object(Value &out)
-    {
-        raw_iter++;
-        out.init_object();
-        ParseStatus ret;
-        parse_whitespace();
-        if (*raw_iter == '}')
+        if (PEEK_AT(iter, raw_end) == '.')
         {
-            raw_iter++;
-            return ParseStatus::OK;
+            iter++;
+            if (!IS_DIGIT09(PEEK_AT(iter, raw_end)))
+                return ParseStatus::INVALID_VALUE;
+            do
+            {
+                if (sig_digits < MANTISSA_MAX_DIGITS)
+                {
+                    // leading zeros of a fraction only move the exponent
+                    mantissa = mantissa * 10 + (*iter - '0');
+                    sig_digits += mantissa != 0;
+                    exp10--;
+                }
+                else
+                    truncated |= *iter != '0';
+                iter++;
+            } while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
         }
-        while (true)
+
+        if (PEEK_AT(iter, raw_end) == 'e' || PEEK_AT(iter, raw_end) == 'E')
         {
-            if (*raw_iter != '"')
-            {
-                ret = ParseStatus::MISS_OBJECT_KEY;
-                break;
+            bool neg_exp = false;
+            int64_t e = 0;
+            iter++;
+            if (PEEK_AT(iter, raw_end) == '+' || PEEK_AT(iter, raw_end) == '-')
+                neg_exp = *iter++ == '-';
+            if (!IS_DIGIT09(PEEK_AT(iter, raw_end)))
+                return ParseStatus::INVALID_VALUE;
+            do
+            {
+                // anything this far out is zero or infinity anyway
+                if (e < 0x10000000)
+                    e = e * 10 + (*iter - '0');
+                iter++;
+            } while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
+            exp10 += neg_exp ? -e : e;
+        }
+
+        double value = decimal_to_double(negative, mantissa, exp10, truncated, raw_iter + negative, iter);
+        if (value == HUGE_VAL || value == -HUGE_VAL)
+            return ParseStatus::NUMBER_TOO_LARGE;
+        out.set_number(value);
+        raw_iter = iter;
+        return ParseStatus::OK;
+    }
+
+    ParseStatus __parser::exec_indexed(Value &out)
+    {
+        ParseStatus ret;
+        // an open string hides where the tokens are, only the serial engine finds the first error
+        if (!build_index())
+            return exec_serial(out);
+        // the walk reports the status the serial engine would, at the same token
+        if ((ret = walk_value(out, ParseStatus::ROOT_NOT_SINGULAR)) == ParseStatus::OK && index_iter != index_end)
+            ret = ParseStatus::ROOT_NOT_SINGULAR;
+        if (ret != ParseStatus::OK)
+        {
+            out.set_literal(ValueType::None);
+            cstack.set_top(0);
+        }
+        return ret;
+    }
+
+    // stage 1: classify 64-byte blocks, mask out the inside of strings and keep the offsets of
+    // operators and of the first byte of every other token. false if a string is left open.
+    bool __parser::build_index()
+    {
+        size_t len = raw_end - raw_begin;
+        uint64_t prev_escaped = 0, prev_in_string = 0, prev_scalar = 0;
+        block_masks m;
+        char tail[64];
+        index.clear();
+        for (size_t base = 0; base < len; base += 64)
+        {
+            const char *block = raw_begin + base;
+            if (len - base < 64)
+            {
+                // spaces neither start tokens nor close strings
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, len - base);
+                block = tail;
             }
-            size_t str_len;
-            if ((ret = parse_string_raw(str_len)) != ParseStatus::OK)
-                break;
-            parse_whitespace();
-            if (*raw_iter != ':')
+            classify_block(block, m);
+            uint64_t quote = m.quote & ~find_escaped(m.backslash, prev_escaped);
+            uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+            prev_in_string = uint64_t(int64_t(in_string) >> 63);
+            // a token starts at a byte that is no operator or space and does not follow a token byte,
+            // a closing quote counts as a separator so that junk after a string gets its own entry
+            uint64_t scalar = ~(m.op | m.space);
+            uint64_t nonquote_scalar = scalar & ~quote;
+            uint64_t follows_scalar = nonquote_scalar << 1 | prev_scalar;
+            prev_scalar = nonquote_scalar >> 63;
+            // in_string ^ quote is the inside of strings plus their closing quotes
+            uint64_t structurals = (m.op | (scalar & ~follows_scalar)) & ~(in_string ^ quote);
+            while (structurals != 0)
             {
-                ret = ParseStatus::MISS_OBJECT_SYMBOL;
-                break;
+                index.push_back(uint32_t(base + __builtin_ctzll(structurals)));
+                structurals &= structurals - 1;
             }
-            raw_iter++;
-            parse_whitespace();
+        }
+        index_iter = index.data();
+        index_end = index.data() + index.size();
+        return prev_in_string == 0;
+    }
+
+    char __parser::peek_index() const
+    {
+        return index_iter != index_end ? raw_begin[*index_iter] : '\0';
+    }
+
+    // a token parsed from the index must end right before the next entry or some whitespace
+    bool __parser::at_index_boundary() const
+    {
+        const char *next = index_iter != index_end ? raw_begin + *index_iter : raw_end;
+        return raw_iter == next || (raw_iter < next && IS_WHITESPACE(*raw_iter));
+    }
+
+    // stage 2: tokens are decoded by the same routines as in the serial engine,
+    // the index only replaces whitespace skipping and finding where the next one starts.
+    // junk is the status for bytes glued to a scalar, what the serial engine reports after it.
+    ParseStatus __parser::walk_value(Value &out, ParseStatus junk)
+    {
+        ParseStatus ret;
+        switch (peek_index())
+        {
+        case '[':
+            return nested([&] { return walk_array(out); });
+        case '{':
+            return nested([&] { return walk_object(out); });
+        case '\0':
+            return ParseStatus::UNEXPECTED_SYMBOL;
+        case ']':
+        case '}':
+        case ',':
+        case ':':
+            // no number can start here
+            return ParseStatus::INVALID_VALUE;
+        default:
+            raw_iter = raw_begin + *index_iter++;
+            if ((ret = parse_scalar(out)) != ParseStatus::OK)
+                return ret;
+            return at_index_boundary() ? ParseStatus::OK : junk;
+        }
+    }
+
+    ParseStatus __parser::walk_array(Value &out)
+    {
+        ParseStatus ret;
+        index_iter++;
+        out.init_array(arena);
+        if (peek_index() == ']')
+        {
+            index_iter++;
+            return ParseStatus::OK;
+        }
+        while (true)
+        {
             Value tmp;
-            if ((ret = parse_value(tmp)) != ParseStatus::OK)
+            if ((ret = walk_value(tmp, ParseStatus::MISS_ARRAY_SYMBOL)) != ParseStatus::OK)
+                return ret;
+            out.array_push_back(move(tmp));
+            switch (peek_index())
             {
+            case ',':
+                index_iter++;
                 break;
+            case ']':
+                index_iter++;
+                return ParseStatus::OK;
+            default:
+                return ParseStatus::MISS_ARRAY_SYMBOL;
             }
-            out.object_insert(std::string((char *)cstack.pop(str_len), 0, str_len), move(tmp));
-            parse_whitespace();
-            if (*raw_iter == ',')
+        }
+    }
+
+    ParseStatus __parser::walk_object(Value &out)
+    {
+        ParseStatus ret;
+        index_iter++;
+        out.init_object(arena, opts.intern);
+        if (peek_index() == '}')
+        {
+            index_iter++;
+            return ParseStatus::OK;
+        }
+        while (true)
+        {
+            if (peek_index() != '"')
+                return ParseStatus::MISS_OBJECT_KEY;
+            const char *key_in_place;
+            size_t str_len;
+            raw_iter = raw_begin + *index_iter++;
+            if ((ret = parse_string_raw(key_in_place, str_len)) != ParseStatus::OK)
+                return ret;
+            if (!at_index_boundary() || peek_index() != ':')
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+            index_iter++;
+            Value tmp;
+            if ((ret = walk_value(tmp, ParseStatus::MISS_OBJECT_SYMBOL)) != ParseStatus::OK)
+                return ret;
+            bool borrow_key = key_in_place != nullptr && arena != nullptr && opts.borrow_strings;
+            if (key_in_place == nullptr)
+                key_in_place = (char *)cstack.pop(str_len);
+            out.object_insert(std::string_view(key_in_place, str_len), move(tmp), borrow_key);
+            switch (peek_index())
             {
-                raw_iter++;
-                parse_whitespace();
+            case ',':
+                index_iter++;
+                break;
+            case '}':
+                index_iter++;
+                return ParseStatus::OK;
+            default:
+                return ParseStatus::MISS_OBJECT_SYMBOL;
             }
-            else if (*raw_iter == '}')
+        }
+    }
+
+    std::pair<ParseStatus, json> parse(const char *str)
+    {
+        return parse(str, std::strlen(str));
+    }
+
+    std::pair<ParseStatus, json> parse(const char *data, size_t len, const ParseOptions &opts)
+    {
+        Value result;
+        __parser ps(data, len, opts);
+        auto status = ps.exec(result);
+        return {status, move(result)};
+    }
+
+    std::pair<ParseStatus, json> parse(std::string_view input, const ParseOptions &opts)
+    {
+        return parse(input.data(), input.size(), opts);
+    }
+
+#pragma endregion
+
+#pragma region lazy
+
+    ParseStatus __parser::skip_value()
+    {
+        switch (PEEK_AT(raw_iter, raw_end))
+        {
+        case '"':
+            return skip_string();
+        case '[':
+            return nested([&] { return skip_array(); });
+        case '{':
+            return nested([&] { return skip_object(); });
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            // literals never allocate
+            Value tmp;
+            return parse_value(tmp);
+        }
+        default:
+            if (raw_iter == raw_end)
+                return ParseStatus::UNEXPECTED_SYMBOL;
+            return skip_number();
+        }
+    }
+
+    // checks a string like parse_string_raw does, without decoding the escapes
+    ParseStatus __parser::skip_string()
+    {
+        const char *iter = raw_iter + 1;
+        unsigned uh, ul;
+        while (true)
+        {
+            iter = scan_string(iter, raw_end, opts.padded);
+            if (iter == raw_end)
             {
-                raw_iter++;
-                break;
+                raw_iter = iter;
+                return ParseStatus::MISS_QUOTATION_MARK;
             }
-            else
+            raw_iter = iter;
+            switch (*iter++)
             {
-                ret = ParseStatus::MISS_OBJECT_SYMBOL;
+            case '"':
+                raw_iter = iter;
+                return ParseStatus::OK;
+            case '\\':
+                switch (iter != raw_end ? *iter++ : '\0')
+                {
+                case '"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    break;
+                case 'u':
+                    if (raw_end - iter < 4 || !hex4_to_ui(iter, uh))
+                        return ParseStatus::INVALID_UNICODE_HEX;
+                    iter += 4;
+                    if (IS_SURROGATE_H(uh))
+                    {
+                        if (iter == raw_end || *iter++ != '\\' || iter == raw_end || *iter++ != 'u')
+                            return ParseStatus::INVALID_UNICODE_SURROGATE;
+                        if (raw_end - iter < 4 || !hex4_to_ui(iter, ul))
+                            return ParseStatus::INVALID_UNICODE_HEX;
+                        iter += 4;
+                        if (IS_SURROGATE_L(ul))
+                            return ParseStatus::INVALID_UNICODE_SURROGATE;
+                    }
+                    break;
+                default:
+                    return ParseStatus::INVALID_STRING_ESCAPE;
+                }
                 break;
+            default:
+                return ParseStatus::INVALID_STRING_CHAR;
             }
         }
-        return ret;
     }
 
-    ParseStatus __parser::parse_number(Value &out)
+    // checks the grammar of parse_number without converting. only a value that may be out of
+    // range, 10^300 or more, is converted to get NUMBER_TOO_LARGE right.
+    ParseStatus __parser::skip_number()
     {
         const char *iter = raw_iter;
-        char *endp = nullptr;
-        if (*iter == '-')
+        int64_t magnitude = 0; // digits before the point plus the exponent
+        if (PEEK_AT(iter, raw_end) == '-')
             iter++;
-
-        if (*iter == '0')
+        if (PEEK_AT(iter, raw_end) == '0')
+        {
             iter++;
+            if (IS_DIGIT09(PEEK_AT(iter, raw_end)) || PEEK_AT(iter, raw_end) == 'x' || PEEK_AT(iter, raw_end) == 'X')
+                return ParseStatus::INVALID_VALUE;
+        }
         else
         {
-            if (!IS_DIGIT19(*iter))
+            if (!IS_DIGIT19(PEEK_AT(iter, raw_end)))
                 return ParseStatus::INVALID_VALUE;
             do
+            {
+                magnitude++;
                 iter++;
-            while (IS_DIGIT09(*iter));
+            } while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
         }
-
-        if (*iter == '.')
+        if (PEEK_AT(iter, raw_end) == '.')
         {
             iter++;
-            if (!IS_DIGIT09(*iter))
+            if (!IS_DIGIT09(PEEK_AT(iter, raw_end)))
                 return ParseStatus::INVALID_VALUE;
             do
                 iter++;
-            while (IS_DIGIT09(*iter));
+            while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
         }
-
-        if (*iter == 'e' || *iter == 'E')
+        if (PEEK_AT(iter, raw_end) == 'e' || PEEK_AT(iter, raw_end) == 'E')
         {
+            bool neg_exp = false;
+            int64_t e = 0;
             iter++;
-            if (*iter == '+' || *iter == '-')
-                iter++;
-            if (!IS_DIGIT09(*iter))
+            if (PEEK_AT(iter, raw_end) == '+' || PEEK_AT(iter, raw_end) == '-')
+                neg_exp = *iter++ == '-';
+            if (!IS_DIGIT09(PEEK_AT(iter, raw_end)))
                 return ParseStatus::INVALID_VALUE;
             do
+            {
+                if (e < 0x10000000)
+                    e = e * 10 + (*iter - '0');
                 iter++;
-            while (IS_DIGIT09(*iter));
+            } while (IS_DIGIT09(PEEK_AT(iter, raw_end)));
+            magnitude += neg_exp ? -e : e;
+        }
+        if (magnitude >= 300)
+        {
+            Value tmp;
+            return parse_number(tmp);
         }
-        errno = 0;
-        out.set_number(std::strtod(raw_iter, &endp));
-        if (endp != iter)
-            return ParseStatus::INVALID_VALUE;
-        if (errno == ERANGE && (out.as_number() == HUGE_VAL || out.as_number() == -HUGE_VAL))
-            return ParseStatus::NUMBER_TOO_LARGE;
         raw_iter = iter;
         return ParseStatus::OK;
     }
 
-    std::pair<ParseStatus, json> parse(const char *str)
+    std::pair<ParseStatus, size_t> validate(std::string_view input, const ParseOptions &opts)
     {
-        Value result;
-        __parser ps(str);
-        auto status = ps.exec(result);
-        return {status, move(result)};
+        __parser ps(input.data(), input.size(), opts);
+        ParseStatus ret;
+        ps.parse_whitespace();
+        if ((ret = ps.skip_value()) == ParseStatus::OK)
+        {
+            ps.parse_whitespace();
+            if (ps.raw_iter != ps.raw_end)
+                ret = ParseStatus::ROOT_NOT_SINGULAR;
+        }
+        return {ret, size_t(ps.raw_iter - ps.raw_begin)};
     }
 
-#pragma endregion
+    ParseStatus __parser::skip_array()
+    {
+        ParseStatus ret;
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == ']')
+        {
+            raw_iter++;
+            return ParseStatus::OK;
+        }
+        while (true)
+        {
+            if ((ret = skip_value()) != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) == ',')
+            {
+                raw_iter++;
+                parse_whitespace();
+            }
+            else if (PEEK_AT(raw_iter, raw_end) == ']')
+            {
+                raw_iter++;
+                return ParseStatus::OK;
+            }
+            else
+                return ParseStatus::MISS_ARRAY_SYMBOL;
+        }
+    }
+
+    ParseStatus __parser::skip_object()
+    {
+        ParseStatus ret;
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == '}')
+        {
+            raw_iter++;
+            return ParseStatus::OK;
+        }
+        while (true)
+        {
+            if (PEEK_AT(raw_iter, raw_end) != '"')
+                return ParseStatus::MISS_OBJECT_KEY;
+            if ((ret = skip_value()) != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) != ':')
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+            raw_iter++;
+            parse_whitespace();
+            if ((ret = skip_value()) != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) == ',')
+            {
+                raw_iter++;
+                parse_whitespace();
+            }
+            else if (PEEK_AT(raw_iter, raw_end) == '}')
+            {
+                raw_iter++;
+                return ParseStatus::OK;
+            }
+            else
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+        }
+    }
 
-}
\ No newline at end of file
+    ParseStatus __parser::lazy_find(std::string_view k, const char *&found)
+    {
+        ParseStatus ret;
+        found = nullptr;
+        if (PEEK_AT(raw_iter, raw_end) != '{')
+            return ParseStatus::OK;
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == '}')
+            return ParseStatus::OK;
+        while (true)
+        {
+            if (PEEK_AT(raw_iter, raw_end) != '"')
+                return ParseStatus::MISS_OBJECT_KEY;
+            const char *key;
+            size_t key_len, top = cstack.get_top();
+            if ((ret = parse_string_raw(key, key_len)) != ParseStatus::OK)
+                return ret;
+            if (key == nullptr)
+                key = (char *)cstack.pop(key_len);
+            bool match = std::string_view(key, key_len) == k;
+            cstack.set_top(top);
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) != ':')
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+            raw_iter++;
+            parse_whitespace();
+            // the first duplicate wins, as in a Value
+            if (match)
+            {
+                found = raw_iter;
+                return ParseStatus::OK;
+            }
+            if ((ret = skip_value()) != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) == ',')
+            {
+                raw_iter++;
+                parse_whitespace();
+            }
+            else if (PEEK_AT(raw_iter, raw_end) == '}')
+                return ParseStatus::OK;
+            else
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+        }
+    }
+
+    ParseStatus __parser::lazy_at(size_t idx, const char *&found)
+    {
+        ParseStatus ret;
+        found = nullptr;
+        if (PEEK_AT(raw_iter, raw_end) != '[')
+            return ParseStatus::OK;
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == ']')
+            return ParseStatus::OK;
+        for (; idx > 0; idx--)
+        {
+            if ((ret = lazy_next(found)) != ParseStatus::OK || found == nullptr)
+                return ret;
+        }
+        found = raw_iter;
+        return ParseStatus::OK;
+    }
+
+    // from an element to the next one
+    ParseStatus __parser::lazy_next(const char *&found)
+    {
+        ParseStatus ret;
+        found = nullptr;
+        if ((ret = skip_value()) != ParseStatus::OK)
+            return ret;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == ',')
+        {
+            raw_iter++;
+            parse_whitespace();
+            found = raw_iter;
+            return ParseStatus::OK;
+        }
+        if (PEEK_AT(raw_iter, raw_end) == ']')
+            return ParseStatus::OK;
+        return ParseStatus::MISS_ARRAY_SYMBOL;
+    }
+
+    std::pair<ParseStatus, LazyValue> parse_lazy(std::string_view input, const ParseOptions &opts)
+    {
+        __parser ps(input.data(), input.size(), opts);
+        ps.parse_whitespace();
+        if (ps.raw_iter == ps.raw_end)
+            return {ParseStatus::UNEXPECTED_SYMBOL, LazyValue()};
+        return {ParseStatus::OK, LazyValue(ps.raw_iter, ps.raw_end, opts)};
+    }
+
+    LazyValue::LazyValue() : begin(nullptr), end(nullptr) {}
+
+    LazyValue::LazyValue(const char *begin, const char *end, const ParseOptions &opts)
+        : begin(begin), end(end), opts(opts) {}
+
+    ValueType LazyValue::get_type() const
+    {
+        if (begin == nullptr || begin == end)
+            return ValueType::None;
+        switch (*begin)
+        {
+        case 'n':
+            return ValueType::Null;
+        case 't':
+        case 'f':
+            return ValueType::Bool;
+        case '"':
+            return ValueType::String;
+        case '[':
+            return ValueType::Array;
+        case '{':
+            return ValueType::Object;
+        default:
+            return *begin == '-' || IS_DIGIT09(*begin) ? ValueType::Number : ValueType::None;
+        }
+    }
+
+    std::pair<ParseStatus, LazyValue> LazyValue::find(std::string_view k) const
+    {
+        const char *found = nullptr;
+        if (begin == nullptr)
+            return {ParseStatus::OK, LazyValue()};
+        __parser ps(begin, end - begin, opts);
+        ParseStatus ret = ps.lazy_find(k, found);
+        if (ret != ParseStatus::OK || found == nullptr)
+            return {ret, LazyValue()};
+        return {ret, LazyValue(found, end, opts)};
+    }
+
+    std::pair<ParseStatus, LazyValue> LazyValue::at(size_t idx) const
+    {
+        const char *found = nullptr;
+        if (begin == nullptr)
+            return {ParseStatus::OK, LazyValue()};
+        __parser ps(begin, end - begin, opts);
+        ParseStatus ret = ps.lazy_at(idx, found);
+        if (ret != ParseStatus::OK || found == nullptr)
+            return {ret, LazyValue()};
+        return {ret, LazyValue(found, end, opts)};
+    }
+
+    std::pair<ParseStatus, json> LazyValue::get() const
+    {
+        Value result;
+        if (begin == nullptr)
+            return {ParseStatus::OK, move(result)};
+        __parser ps(begin, end - begin, opts);
+        auto status = ps.parse_value(result);
+        if (status != ParseStatus::OK)
+            result = Value();
+        return {status, move(result)};
+    }
+
+    LazyValue::array_iterator LazyValue::array_begin() const
+    {
+        if (get_type() != ValueType::Array)
+            return array_iterator();
+        __parser ps(begin + 1, end - begin - 1, opts);
+        ps.parse_whitespace();
+        if (PEEK_AT(ps.raw_iter, ps.raw_end) == ']')
+            return array_iterator();
+        return array_iterator(LazyValue(ps.raw_iter, end, opts));
+    }
+
+    LazyValue::array_iterator LazyValue::array_end() const { return array_iterator(); }
+
+    __lazy_array_iterator::__lazy_array_iterator() : error(ParseStatus::OK) {}
+
+    __lazy_array_iterator::__lazy_array_iterator(const LazyValue &first) : cur(first), error(ParseStatus::OK) {}
+
+    const LazyValue &__lazy_array_iterator::operator*() const { return cur; }
+
+    const LazyValue *__lazy_array_iterator::operator->() const { return &cur; }
+
+    __lazy_array_iterator &__lazy_array_iterator::operator++()
+    {
+        const char *found = nullptr;
+        __parser ps(cur.begin, cur.end - cur.begin, cur.opts);
+        error = ps.lazy_next(found);
+        cur = found != nullptr && error == ParseStatus::OK ? LazyValue(found, cur.end, cur.opts) : LazyValue();
+        return *this;
+    }
+
+    ParseStatus __lazy_array_iterator::status() const { return error; }
+
+    bool __lazy_array_iterator::operator==(const self_type &another) const { return cur.begin == another.cur.begin; }
+
+    bool __lazy_array_iterator::operator!=(const self_type &another) const { return cur.begin != another.cur.begin; }
+
+#pragma endregion
+
+#pragma region query
+
+    // "0" and digits without a leading zero
+    static size_t path_index(std::string_view token)
+    {
+        size_t idx = 0;
+        if (token.empty() || token.size() > 19 || (token[0] == '0' && token.size() > 1))
+            return SIZE_MAX;
+        for (char c : token)
+        {
+            if (!IS_DIGIT09(c))
+                return SIZE_MAX;
+            idx = idx * 10 + (c - '0');
+        }
+        return idx;
+    }
+
+    ParseStatus Query::compile_pointer(std::string_view path, std::vector<__query_step> &steps)
+    {
+        while (!path.empty())
+        {
+            if (path[0] != '/')
+                return ParseStatus::INVALID_PATH;
+            size_t end = path.find('/', 1);
+            std::string_view raw = path.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+            path.remove_prefix(1 + raw.size());
+            __query_step step{std::string(), path_index(raw), raw == "*", false};
+            for (size_t i = 0; i < raw.size(); i++)
+            {
+                if (raw[i] != '~')
+                    step.key += raw[i];
+                else if (i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1'))
+                    step.key += raw[++i] == '0' ? '~' : '/';
+                else
+                    return ParseStatus::INVALID_PATH;
+            }
+            steps.push_back(std::move(step));
+        }
+        return ParseStatus::OK;
+    }
+
+    ParseStatus Query::compile_jsonpath(std::string_view path, std::vector<__query_step> &steps)
+    {
+        size_t i = 1; // after '$'
+        while (i < path.size())
+        {
+            __query_step step{std::string(), SIZE_MAX, false, false};
+            if (path[i] == '.')
+            {
+                size_t end = path.find_first_of(".[", ++i);
+                std::string_view name = path.substr(i, end == std::string_view::npos ? std::string_view::npos : end - i);
+                // ".." would be a recursive descent
+                if (name.empty())
+                    return ParseStatus::INVALID_PATH;
+                step.any = name == "*";
+                step.key = name;
+                i += name.size();
+            }
+            else if (path[i] == '[')
+            {
+                size_t end = ++i;
+                if (end < path.size() && (path[end] == '\'' || path[end] == '"'))
+                {
+                    // a quoted key, backslash escapes the next byte
+                    char quote = path[end++];
+                    while (end < path.size() && path[end] != quote)
+                    {
+                        if (path[end] == '\\' && ++end == path.size())
+                            return ParseStatus::INVALID_PATH;
+                        step.key += path[end++];
+                    }
+                    if (end + 1 >= path.size() || path[end + 1] != ']')
+                        return ParseStatus::INVALID_PATH;
+                    i = end + 2;
+                }
+                else
+                {
+                    end = path.find(']', i);
+                    if (end == std::string_view::npos)
+                        return ParseStatus::INVALID_PATH;
+                    std::string_view token = path.substr(i, end - i);
+                    step.any = token == "*";
+                    step.index = path_index(token);
+                    step.array_only = true;
+                    if (!step.any && step.index == SIZE_MAX)
+                        return ParseStatus::INVALID_PATH;
+                    i = end + 1;
+                }
+            }
+            else
+                return ParseStatus::INVALID_PATH;
+            steps.push_back(std::move(step));
+        }
+        return ParseStatus::OK;
+    }
+
+    ParseStatus Query::add(std::string_view path)
+    {
+        std::vector<__query_step> steps;
+        ParseStatus ret = !path.empty() && path[0] == '$' ? compile_jsonpath(path, steps) : compile_pointer(path, steps);
+        if (ret == ParseStatus::OK)
+            paths.push_back(std::move(steps));
+        return ret;
+    }
+
+    size_t Query::size() const
+    {
+        return paths.size();
+    }
+
+    std::pair<ParseStatus, std::vector<QueryMatch>> Query::run(std::string_view input, const ParseOptions &opts) const
+    {
+        std::vector<QueryMatch> out;
+        __parser ps(input.data(), input.size(), opts);
+        auto status = ps.exec(*this, out);
+        if (status != ParseStatus::OK)
+            out.clear();
+        return {status, std::move(out)};
+    }
+
+    ParseStatus __parser::exec(const Query &q, std::vector<QueryMatch> &out)
+    {
+        ParseStatus ret;
+        std::vector<uint32_t> active;
+        for (size_t i = 0; i < q.paths.size(); i++)
+            active.push_back(uint32_t(i));
+        parse_whitespace();
+        if ((ret = query_value(q, 0, active, 0, out)) == ParseStatus::OK)
+        {
+            parse_whitespace();
+            if (raw_iter != raw_end)
+                ret = ParseStatus::ROOT_NOT_SINGULAR;
+        }
+        return ret;
+    }
+
+    ParseStatus __parser::query_value(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first,
+                                      std::vector<QueryMatch> &out)
+    {
+        ParseStatus ret;
+        bool deeper = false;
+        const char *start = raw_iter;
+        size_t taken = SIZE_MAX;
+        for (size_t i = first; i < active.size(); i++)
+        {
+            if (q.paths[active[i]].size() != depth)
+                deeper = true;
+            else if (taken == SIZE_MAX)
+            {
+                // paths that end here get the whole value, built only once
+                taken = out.size();
+                out.push_back(QueryMatch{active[i], Value()});
+                if ((ret = parse_value(out.back().value)) != ParseStatus::OK)
+                    return ret;
+            }
+            else
+                out.push_back(QueryMatch{active[i], out[taken].value});
+        }
+        if (!deeper)
+            return taken == SIZE_MAX ? skip_value() : ParseStatus::OK;
+        // scanned again for the longer paths
+        raw_iter = start;
+        switch (PEEK_AT(raw_iter, raw_end))
+        {
+        case '[':
+            return nested([&] { return query_array(q, depth, active, first, out); });
+        case '{':
+            return nested([&] { return query_object(q, depth, active, first, out); });
+        default:
+            return skip_value();
+        }
+    }
+
+    ParseStatus __parser::query_array(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first,
+                                      std::vector<QueryMatch> &out)
+    {
+        ParseStatus ret;
+        size_t last = active.size();
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == ']')
+        {
+            raw_iter++;
+            return ParseStatus::OK;
+        }
+        for (size_t idx = 0;; idx++)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                const auto &steps = q.paths[active[i]];
+                if (steps.size() > depth && (steps[depth].any || steps[depth].index == idx))
+                    active.push_back(active[i]);
+            }
+            ret = active.size() == last ? skip_value() : query_value(q, depth + 1, active, last, out);
+            active.resize(last);
+            if (ret != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) == ',')
+            {
+                raw_iter++;
+                parse_whitespace();
+            }
+            else if (PEEK_AT(raw_iter, raw_end) == ']')
+            {
+                raw_iter++;
+                return ParseStatus::OK;
+            }
+            else
+                return ParseStatus::MISS_ARRAY_SYMBOL;
+        }
+    }
+
+    ParseStatus __parser::query_object(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first,
+                                       std::vector<QueryMatch> &out)
+    {
+        ParseStatus ret;
+        size_t last = active.size();
+        raw_iter++;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) == '}')
+        {
+            raw_iter++;
+            return ParseStatus::OK;
+        }
+        while (true)
+        {
+            if (PEEK_AT(raw_iter, raw_end) != '"')
+                return ParseStatus::MISS_OBJECT_KEY;
+            const char *key;
+            size_t key_len, top = cstack.get_top();
+            if ((ret = parse_string_raw(key, key_len)) != ParseStatus::OK)
+                return ret;
+            if (key == nullptr)
+                key = (char *)cstack.pop(key_len);
+            std::string_view k(key, key_len);
+            for (size_t i = first; i < last; i++)
+            {
+                uint32_t path = active[i] & ~QUERY_TAKEN;
+                if (q.paths[path].size() <= depth)
+                    continue;
+                const __query_step &step = q.paths[path][depth];
+                if (step.any)
+                    active.push_back(path);
+                else if (!step.array_only && (active[i] & QUERY_TAKEN) == 0 && step.key == k)
+                {
+                    active[i] |= QUERY_TAKEN;
+                    active.push_back(path);
+                }
+            }
+            cstack.set_top(top);
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) != ':')
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+            raw_iter++;
+            parse_whitespace();
+            ret = active.size() == last ? skip_value() : query_value(q, depth + 1, active, last, out);
+            active.resize(last);
+            if (ret != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (PEEK_AT(raw_iter, raw_end) == ',')
+            {
+                raw_iter++;
+                parse_whitespace();
+            }
+            else if (PEEK_AT(raw_iter, raw_end) == '}')
+            {
+                raw_iter++;
+                break;
+            }
+            else
+                return ParseStatus::MISS_OBJECT_SYMBOL;
+        }
+        for (size_t i = first; i < last; i++)
+            active[i] &= ~QUERY_TAKEN;
+        return ParseStatus::OK;
+    }
+
+#pragma endregion
+
+#pragma region sax
+
+    ParseStatus __parser::exec(SaxHandler &h)
+    {
+        ParseStatus ret;
+        parse_whitespace();
+        if ((ret = sax_value(h)) == ParseStatus::OK)
+        {
+            parse_whitespace();
+            if (raw_iter != raw_end)
+            {
+                ret = ParseStatus::ROOT_NOT_SINGULAR;
+            }
+        }
+        return ret;
+    }
+
+    ParseStatus __parser::sax_value(SaxHandler &h)
+    {
+        ParseStatus ret;
+        bool go_on = true;
+        if (raw_iter == raw_end)
+            return ParseStatus::UNEXPECTED_SYMBOL;
+        switch (*raw_iter)
+        {
+        case '[':
+            return nested([&] { return sax_array(h); });
+        case '{':
+            return nested([&] { return sax_object(h); });
+        case '"':
+        {
+            const char *in_place;
+            size_t length, top = cstack.get_top();
+            if ((ret = parse_string_raw(in_place, length)) != ParseStatus::OK)
+                return ret;
+            if (in_place == nullptr)
+                in_place = (char *)cstack.pop(length);
+            go_on = h.string(std::string_view(in_place, length));
+            cstack.set_top(top);
+            break;
+        }
+        default:
+        {
+            // literals and numbers never allocate
+            Value tmp;
+            if ((ret = parse_value(tmp)) != ParseStatus::OK)
+                return ret;
+            switch (tmp.type)
+            {
+            case ValueType::Bool:
+                go_on = h.boolean(tmp.bool_val);
+                break;
+            case ValueType::Number:
+                if (tmp.number_kind == Value::NumberKind::Int64)
+                    go_on = h.int64(tmp.int_val);
+                else if (tmp.number_kind == Value::NumberKind::Uint64)
+                    go_on = h.uint64(tmp.uint_val);
+                else
+                    go_on = h.number(tmp.number_val);
+                break;
+            case ValueType::Null:
+            default:
+                go_on = h.null();
+                break;
+            }
+            break;
+        }
+        }
+        return go_on ? ParseStatus::OK : ParseStatus::ABORTED;
+    }
+
+    ParseStatus __parser::sax_array(SaxHandler &h)
+    {
+        ParseStatus ret;
+        raw_iter++;
+        if (!h.start_array())
+            return ParseStatus::ABORTED;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) != ']')
+        {
+            while (true)
+            {
+                if ((ret = sax_value(h)) != ParseStatus::OK)
+                    return ret;
+                parse_whitespace();
+                if (PEEK_AT(raw_iter, raw_end) == ',')
+                {
+                    raw_iter++;
+                    parse_whitespace();
+                }
+                else if (PEEK_AT(raw_iter, raw_end) == ']')
+                    break;
+                else
+                    return ParseStatus::MISS_ARRAY_SYMBOL;
+            }
+        }
+        raw_iter++;
+        return h.end_array() ? ParseStatus::OK : ParseStatus::ABORTED;
+    }
+
+    ParseStatus __parser::sax_object(SaxHandler &h)
+    {
+        ParseStatus ret;
+        raw_iter++;
+        if (!h.start_object())
+            return ParseStatus::ABORTED;
+        parse_whitespace();
+        if (PEEK_AT(raw_iter, raw_end) != '}')
+        {
+            while (true)
+            {
+                if (PEEK_AT(raw_iter, raw_end) != '"')
+                    return ParseStatus::MISS_OBJECT_KEY;
+                const char *key;
+                size_t key_len, top = cstack.get_top();
+                if ((ret = parse_string_raw(key, key_len)) != ParseStatus::OK)
+                    return ret;
+                if (key == nullptr)
+                    key = (char *)cstack.pop(key_len);
+                bool go_on = h.key(std::string_view(key, key_len));
+                cstack.set_top(top);
+                if (!go_on)
+                    return ParseStatus::ABORTED;
+                parse_whitespace();
+                if (PEEK_AT(raw_iter, raw_end) != ':')
+                    return ParseStatus::MISS_OBJECT_SYMBOL;
+                raw_iter++;
+                parse_whitespace();
+                if ((ret = sax_value(h)) != ParseStatus::OK)
+                    return ret;
+                parse_whitespace();
+                if (PEEK_AT(raw_iter, raw_end) == ',')
+                {
+                    raw_iter++;
+                    parse_whitespace();
+                }
+                else if (PEEK_AT(raw_iter, raw_end) == '}')
+                    break;
+                else
+                    return ParseStatus::MISS_OBJECT_SYMBOL;
+            }
+        }
+        raw_iter++;
+        return h.end_object() ? ParseStatus::OK : ParseStatus::ABORTED;
+    }
+
+    ParseStatus parse_sax(std::string_view input, SaxHandler &handler, const ParseOptions &opts)
+    {
+        __parser ps(input.data(), input.size(), opts);
+        return ps.exec(handler);
+    }
+
+#pragma endregion
+
+#pragma region stream
+
+    // closing quote of a string whose opening quote is already behind p, or end.
+    // escaped carries a backslash that was the last byte of the previous chunk.
+    static const char *find_string_end(const char *p, const char *end, bool &escaped)
+    {
+        if (escaped && p != end)
+        {
+            escaped = false;
+            p++;
+        }
+        while (true)
+        {
+            p = scan_string(p, end, false);
+            if (p == end)
+                return end;
+            if (*p == '"')
+                return p;
+            if (*p == '\\' && ++p == end)
+            {
+                escaped = true;
+                return end;
+            }
+            p++;
+        }
+    }
+
+    static const char *find_token_end(const char *p, const char *end)
+    {
+        while (p != end && IS_TOKEN_CHAR(*p))
+            p++;
+        return p;
+    }
+
+    bool __dom_builder::attach(Value &&v)
+    {
+        if (open.empty())
+            root = std::move(v);
+        else if (open.back().type == ValueType::Array)
+            open.back().array_push_back(std::move(v));
+        else
+        {
+            open.back().object_insert(std::string_view(keys.back()), std::move(v));
+            keys.pop_back();
+        }
+        return true;
+    }
+
+    void __dom_builder::reset()
+    {
+        open.clear();
+        keys.clear();
+        root = Value();
+    }
+
+    bool __dom_builder::null()
+    {
+        Value v;
+        v.set_literal(ValueType::Null);
+        return attach(std::move(v));
+    }
+
+    bool __dom_builder::boolean(bool v) { return attach(Value(v)); }
+
+    bool __dom_builder::number(double v) { return attach(Value(v)); }
+
+    bool __dom_builder::int64(int64_t v) { return attach(Value(v)); }
+
+    bool __dom_builder::uint64(uint64_t v) { return attach(Value(v)); }
+
+    bool __dom_builder::string(std::string_view v)
+    {
+        Value s;
+        s.set_string(v.data(), v.size());
+        return attach(std::move(s));
+    }
+
+    bool __dom_builder::key(std::string_view k)
+    {
+        keys.emplace_back(k);
+        return true;
+    }
+
+    bool __dom_builder::start_object()
+    {
+        open.emplace_back();
+        open.back().init_object();
+        return true;
+    }
+
+    bool __dom_builder::end_object()
+    {
+        Value v = std::move(open.back());
+        open.pop_back();
+        return attach(std::move(v));
+    }
+
+    bool __dom_builder::start_array()
+    {
+        open.emplace_back();
+        open.back().init_array();
+        return true;
+    }
+
+    bool __dom_builder::end_array() { return end_object(); }
+
+    StreamParser::StreamParser(const ParseOptions &opts) : StreamParser(dom, opts) {}
+
+    StreamParser::StreamParser(SaxHandler &handler, const ParseOptions &opts)
+        : handler(&handler), ps(new __parser(nullptr, 0, ParseOptions())),
+          expect(Expect::Value), escaped(false), status(ParseStatus::OK)
+    {
+        ps->opts.max_depth = opts.max_depth;
+    }
+
+    StreamParser::~StreamParser()
+    {
+        delete ps;
+    }
+
+    ParseStatus StreamParser::fail(ParseStatus s)
+    {
+        return status = s;
+    }
+
+    ParseStatus StreamParser::after_value()
+    {
+        expect = open.empty() ? Expect::Done : Expect::Next;
+        return ParseStatus::OK;
+    }
+
+    // a complete token, or an unterminated string at the end of the input
+    ParseStatus StreamParser::emit_value(const char *p, size_t n)
+    {
+        ParseStatus ret;
+        ps->raw_begin = ps->raw_iter = p;
+        ps->raw_end = p + n;
+        if ((ret = ps->sax_value(*handler)) != ParseStatus::OK)
+            return fail(ret);
+        // e.g. "1-2", the rest is where parse() would expect a separator
+        if (ps->raw_iter != ps->raw_end)
+            return fail(open.empty()          ? ParseStatus::ROOT_NOT_SINGULAR
+                        : open.back() == '[' ? ParseStatus::MISS_ARRAY_SYMBOL
+                                             : ParseStatus::MISS_OBJECT_SYMBOL);
+        return after_value();
+    }
+
+    ParseStatus StreamParser::emit_key(const char *p, size_t n)
+    {
+        ParseStatus ret;
+        const char *key;
+        size_t key_len, top = ps->cstack.get_top();
+        ps->raw_begin = ps->raw_iter = p;
+        ps->raw_end = p + n;
+        if ((ret = ps->parse_string_raw(key, key_len)) != ParseStatus::OK)
+            return fail(ret);
+        if (key == nullptr)
+            key = (char *)ps->cstack.pop(key_len);
+        bool go_on = handler->key(std::string_view(key, key_len));
+        ps->cstack.set_top(top);
+        if (!go_on)
+            return fail(ParseStatus::ABORTED);
+        expect = Expect::Colon;
+        return ParseStatus::OK;
+    }
+
+    ParseStatus StreamParser::close(char c)
+    {
+        open.pop_back();
+        if (!(c == ']' ? handler->end_array() : handler->end_object()))
+            return fail(ParseStatus::ABORTED);
+        return after_value();
+    }
+
+    ParseStatus StreamParser::feed(const char *data, size_t len)
+    {
+        const char *p = data, *end = data + len, *stop;
+        if (status != ParseStatus::OK)
+            return status;
+
+        // finish the token the previous chunk ended in
+        if (expect == Expect::String || expect == Expect::KeyString)
+        {
+            stop = find_string_end(p, end, escaped);
+            if (stop == end)
+            {
+                pending.append(p, end);
+                return ParseStatus::OK;
+            }
+            pending.append(p, stop + 1);
+            p = stop + 1;
+            if (expect == Expect::String ? emit_value(pending.data(), pending.size()) != ParseStatus::OK
+                                         : emit_key(pending.data(), pending.size()) != ParseStatus::OK)
+                return status;
+            pending.clear();
+        }
+        else if (expect == Expect::Token)
+        {
+            stop = find_token_end(p, end);
+            pending.append(p, stop);
+            if (stop == end)
+                return ParseStatus::OK;
+            p = stop;
+            if (emit_value(pending.data(), pending.size()) != ParseStatus::OK)
+                return status;
+            pending.clear();
+        }
+
+        while (true)
+        {
+            p = skip_whitespace(p, end, false);
+            if (p == end)
+                return ParseStatus::OK;
+            char c = *p;
+            switch (expect)
+            {
+            case Expect::FirstElement:
+                if (c == ']')
+                {
+                    p++;
+                    if (close(c) != ParseStatus::OK)
+                        return status;
+                    break;
+                }
+                [[fallthrough]];
+            case Expect::Value:
+                if (c == '[' || c == '{')
+                {
+                    if (open.size() >= ps->opts.max_depth)
+                        return fail(ParseStatus::DEPTH_EXCEEDED);
+                    p++;
+                    open.push_back(c);
+                    expect = c == '[' ? Expect::FirstElement : Expect::FirstKey;
+                    if (!(c == '[' ? handler->start_array() : handler->start_object()))
+                        return fail(ParseStatus::ABORTED);
+                }
+                else if (c == '"')
+                {
+                    stop = find_string_end(p + 1, end, escaped);
+                    if (stop == end)
+                    {
+                        pending.assign(p, end);
+                        expect = Expect::String;
+                        return ParseStatus::OK;
+                    }
+                    if (emit_value(p, stop + 1 - p) != ParseStatus::OK)
+                        return status;
+                    p = stop + 1;
+                }
+                else if (IS_TOKEN_CHAR(c))
+                {
+                    // a number or literal may go on in the next chunk
+                    stop = find_token_end(p, end);
+                    if (stop == end)
+                    {
+                        pending.assign(p, end);
+                        expect = Expect::Token;
+                        return ParseStatus::OK;
+                    }
+                    if (emit_value(p, stop - p) != ParseStatus::OK)
+                        return status;
+                    p = stop;
+                }
+                else
+                    return fail(ParseStatus::INVALID_VALUE);
+                break;
+            case Expect::FirstKey:
+                if (c == '}')
+                {
+                    p++;
+                    if (close(c) != ParseStatus::OK)
+                        return status;
+                    break;
+                }
+                [[fallthrough]];
+            case Expect::Key:
+                if (c != '"')
+                    return fail(ParseStatus::MISS_OBJECT_KEY);
+                stop = find_string_end(p + 1, end, escaped);
+                if (stop == end)
+                {
+                    pending.assign(p, end);
+                    expect = Expect::KeyString;
+                    return ParseStatus::OK;
+                }
+                if (emit_key(p, stop + 1 - p) != ParseStatus::OK)
+                    return status;
+                p = stop + 1;
+                break;
+            case Expect::Colon:
+                if (c != ':')
+                    return fail(ParseStatus::MISS_OBJECT_SYMBOL);
+                p++;
+                expect = Expect::Value;
+                break;
+            case Expect::Next:
+                p++;
+                if (c == ',')
+                    expect = open.back() == '[' ? Expect::Value : Expect::Key;
+                else if (c == (open.back() == '[' ? ']' : '}'))
+                {
+                    if (close(c) != ParseStatus::OK)
+                        return status;
+                }
+                else
+                    return fail(open.back() == '[' ? ParseStatus::MISS_ARRAY_SYMBOL : ParseStatus::MISS_OBJECT_SYMBOL);
+                break;
+            default: // Done
+                return fail(ParseStatus::ROOT_NOT_SINGULAR);
+            }
+        }
+    }
+
+    ParseStatus StreamParser::feed(std::string_view chunk)
+    {
+        return feed(chunk.data(), chunk.size());
+    }
+
+    ParseStatus StreamParser::finish()
+    {
+        if (status != ParseStatus::OK)
+            return status;
+        switch (expect)
+        {
+        case Expect::String:
+        case Expect::KeyString:
+            // unterminated, decoding it reports the first problem like parse() does
+            if (expect == Expect::String)
+                return emit_value(pending.data(), pending.size());
+            return emit_key(pending.data(), pending.size());
+        case Expect::Token:
+            if (emit_value(pending.data(), pending.size()) != ParseStatus::OK)
+                return status;
+            pending.clear();
+            return finish();
+        case Expect::Done:
+            return ParseStatus::OK;
+        case Expect::Value:
+        case Expect::FirstElement:
+            return fail(ParseStatus::UNEXPECTED_SYMBOL);
+        case Expect::FirstKey:
+        case Expect::Key:
+            return fail(ParseStatus::MISS_OBJECT_KEY);
+        case Expect::Colon:
+            return fail(ParseStatus::MISS_OBJECT_SYMBOL);
+        default: // Next
+            return fail(open.back() == '[' ? ParseStatus::MISS_ARRAY_SYMBOL : ParseStatus::MISS_OBJECT_SYMBOL);
+        }
+    }
+
+    void StreamParser::reset()
+    {
+        dom.reset();
+        open.clear();
+        pending.clear();
+        expect = Expect::Value;
+        escaped = false;
+        status = ParseStatus::OK;
+    }
+
+    Value &StreamParser::root()
+    {
+        return dom.root;
+    }
+
+    size_t StreamParser::buffered() const
+    {
+        return pending.size();
+    }
+
+#pragma endregion
+
+#pragma region parallel
+
+    // pre-pass of exec_parallel, finds commas between the elements of a top-level array about
+    // len / parts bytes apart and the closing bracket. false if the input does not look like one
+    // array, the serial parse then tells why.
+    static bool find_array_cuts(const char *begin, const char *end, size_t parts,
+                                std::vector<const char *> &cuts, const char *&close)
+    {
+        begin = skip_whitespace(begin, end, false);
+        if (begin == end || *begin != '[')
+            return false;
+        size_t len = end - begin, step = len / parts, next_cut = step, depth = 0;
+        uint64_t prev_escaped = 0, prev_in_string = 0;
+        block_masks m;
+        char tail[64];
+        cuts.push_back(begin);
+        for (size_t base = 0; base < len; base += 64)
+        {
+            const char *block = begin + base;
+            if (len - base < 64)
+            {
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, len - base);
+                block = tail;
+            }
+            classify_block(block, m);
+            uint64_t quote = m.quote & ~find_escaped(m.backslash, prev_escaped);
+            uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+            prev_in_string = uint64_t(int64_t(in_string) >> 63);
+            for (uint64_t ops = m.op & ~in_string; ops != 0; ops &= ops - 1)
+            {
+                size_t pos = base + __builtin_ctzll(ops);
+                switch (begin[pos])
+                {
+                case '[':
+                case '{':
+                    depth++;
+                    break;
+                case ']':
+                case '}':
+                    if (--depth == 0)
+                    {
+                        close = begin + pos;
+                        return true;
+                    }
+                    break;
+                case ',':
+                    if (depth == 1 && pos >= next_cut)
+                    {
+                        cuts.push_back(begin + pos);
+                        next_cut = pos + step;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        return false;
+    }
+
+    // the values of one part, separated by commas and filling the whole range
+    ParseStatus __parser::parse_elements(std::vector<Value> &out)
+    {
+        ParseStatus ret;
+        parse_whitespace();
+        while (true)
+        {
+            out.emplace_back();
+            if ((ret = parse_value(out.back())) != ParseStatus::OK)
+                return ret;
+            parse_whitespace();
+            if (raw_iter == raw_end)
+                return ParseStatus::OK;
+            if (*raw_iter != ',')
+                return ParseStatus::MISS_ARRAY_SYMBOL;
+            raw_iter++;
+            parse_whitespace();
+        }
+    }
+
+    // any failure, including input that is no array, is left to the serial parse so that
+    // the status is exactly the one it reports
+    ParseStatus __parser::exec_parallel(Value &out)
+    {
+        unsigned threads = opts.threads != 0 ? opts.threads : std::thread::hardware_concurrency();
+        size_t parts = std::min<size_t>(threads, (raw_end - raw_iter) / PARALLEL_MIN_PART);
+        std::vector<const char *> cuts;
+        const char *close;
+        // the depth count also drops to 0 at a '}' that closes the root array by mistake
+        if (parts < 2 || opts.max_depth == 0 || !find_array_cuts(raw_iter, raw_end, parts, cuts, close) || cuts.size() < 2 ||
+            *close != ']' || skip_whitespace(close + 1, raw_end, false) != raw_end)
+            return exec_serial(out);
+
+        // part k lies between cuts[k] and cuts[k + 1], the '[', the commas and the ']'
+        cuts.push_back(close);
+        size_t n = cuts.size() - 1;
+        std::vector<std::vector<Value>> elements(n);
+        std::vector<ParseStatus> status(n);
+        auto work = [&](size_t k)
+        {
+            __parser ps(cuts[k] + 1, cuts[k + 1] - cuts[k] - 1, opts);
+            // the elements sit inside the outer array
+            ps.nesting = 1;
+            status[k] = ps.parse_elements(elements[k]);
+        };
+        std::vector<std::thread> pool;
+        for (size_t k = 1; k < n; k++)
+            pool.emplace_back(work, k);
+        work(0);
+        for (auto &t : pool)
+            t.join();
+        for (ParseStatus st : status)
+            if (st != ParseStatus::OK)
+                return exec_serial(out);
+
+        // the elements are moved, their strings and containers stay where the workers put them
+        size_t total = 0;
+        for (auto &part : elements)
+            total += part.size();
+        out.init_array(arena);
+        out.parray->reserve(total);
+        for (auto &part : elements)
+            for (auto &v : part)
+                out.parray->push_back(std::move(v));
+        raw_iter = raw_end;
+        return ParseStatus::OK;
+    }
+
+#pragma endregion
+
+#pragma region ndjson
+
+    // parser state a worker thread keeps across its documents
+    class __ndjson_worker
+    {
+        __parser ps;
+
+    public:
+        explicit __ndjson_worker(const ParseOptions &opts) : ps(nullptr, 0, opts) {}
+
+        ParseStatus parse(std::string_view doc, Value &out)
+        {
+            ps.raw_begin = ps.raw_iter = doc.data();
+            ps.raw_end = doc.data() + doc.size();
+            return ps.exec(out);
+        }
+    };
+
+    // a JSON string cannot hold a raw line break, so every '\n' ends a document
+    // and the split needs no quote tracking. a broken line only affects itself.
+    static void split_lines(const char *p, const char *end, std::vector<std::string_view> &docs)
+    {
+        while (p != end)
+        {
+            const char *nl = (const char *)std::memchr(p, '\n', end - p);
+            const char *line_end = nl != nullptr ? nl : end;
+            if (skip_whitespace(p, line_end, false) != line_end)
+                docs.emplace_back(p, line_end - p);
+            p = nl != nullptr ? nl + 1 : end;
+        }
+    }
+
+    static unsigned worker_count(const NdjsonOptions &opts)
+    {
+        unsigned n = opts.threads != 0 ? opts.threads : std::thread::hardware_concurrency();
+        return n != 0 ? n : 1;
+    }
+
+    static void parse_docs(const std::vector<std::string_view> &docs, const NdjsonCallback &callback, const NdjsonOptions &opts)
+    {
+        std::atomic<size_t> next(0);
+        auto work = [&]
+        {
+            __ndjson_worker w(opts.parse);
+            size_t first;
+            while ((first = next.fetch_add(NDJSON_CLAIM)) < docs.size())
+            {
+                size_t last = std::min(first + NDJSON_CLAIM, docs.size());
+                for (size_t i = first; i < last; i++)
+                {
+                    Value v;
+                    ParseStatus st = w.parse(docs[i], v);
+                    callback(i, st, v);
+                }
+            }
+        };
+        // the calling thread is one of the workers
+        size_t n = std::min<size_t>(worker_count(opts), (docs.size() + NDJSON_CLAIM - 1) / NDJSON_CLAIM);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < n; i++)
+            threads.emplace_back(work);
+        work();
+        for (auto &t : threads)
+            t.join();
+    }
+
+    std::vector<std::pair<ParseStatus, json>> parse_ndjson(std::string_view input, const NdjsonOptions &opts)
+    {
+        std::vector<std::string_view> docs;
+        split_lines(input.data(), input.data() + input.size(), docs);
+        std::vector<std::pair<ParseStatus, json>> results(docs.size());
+        parse_docs(docs, [&](size_t i, ParseStatus st, json &v)
+                   { results[i] = {st, std::move(v)}; }, opts);
+        return results;
+    }
+
+    void parse_ndjson(std::string_view input, const NdjsonCallback &callback, const NdjsonOptions &opts)
+    {
+        std::vector<std::string_view> docs;
+        split_lines(input.data(), input.data() + input.size(), docs);
+        parse_docs(docs, callback, opts);
+    }
+
+    // whole lines read by parse_ndjson_fd, the buffer has PARSE_PADDING bytes to spare
+    struct __ndjson_batch
+    {
+        std::vector<char> data;
+        std::vector<std::string_view> docs;
+        size_t first; // index of docs[0]
+    };
+
+    // bounded, the reader waits while the workers are depth batches behind
+    class __ndjson_queue
+    {
+        std::mutex m;
+        std::condition_variable not_empty, not_full;
+        std::deque<__ndjson_batch> batches;
+        std::vector<std::vector<char>> spare; // buffers of finished batches
+        size_t depth;
+        bool closed = false;
+
+    public:
+        explicit __ndjson_queue(size_t depth) : depth(depth != 0 ? depth : 1) {}
+
+        void push(__ndjson_batch &&b)
+        {
+            std::unique_lock<std::mutex> lk(m);
+            not_full.wait(lk, [&]
+                          { return batches.size() < depth; });
+            batches.push_back(std::move(b));
+            not_empty.notify_one();
+        }
+
+        // false once closed and drained
+        bool pop(__ndjson_batch &b)
+        {
+            std::unique_lock<std::mutex> lk(m);
+            not_empty.wait(lk, [&]
+                           { return !batches.empty() || closed; });
+            if (batches.empty())
+                return false;
+            b = std::move(batches.front());
+            batches.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lk(m);
+            closed = true;
+            not_empty.notify_all();
+        }
+
+        void give_back(std::vector<char> &&data)
+        {
+            std::lock_guard<std::mutex> lk(m);
+            spare.push_back(std::move(data));
+        }
+
+        // an empty vector when no buffer is spare
+        std::vector<char> take()
+        {
+            std::lock_guard<std::mutex> lk(m);
+            std::vector<char> data;
+            if (!spare.empty())
+            {
+                data = std::move(spare.back());
+                spare.pop_back();
+            }
+            return data;
+        }
+    };
+
+    bool parse_ndjson_fd(int fd, const NdjsonCallback &callback, const NdjsonOptions &opts)
+    {
+        // batches are dropped after their callbacks and always padded
+        ParseOptions popts = opts.parse;
+        popts.borrow_strings = false;
+        popts.padded = true;
+
+        __ndjson_queue queue(opts.queue_depth);
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < worker_count(opts); i++)
+            threads.emplace_back([&]
+                                 {
+                                     __ndjson_worker w(popts);
+                                     __ndjson_batch b;
+                                     while (queue.pop(b))
+                                     {
+                                         for (size_t j = 0; j < b.docs.size(); j++)
+                                         {
+                                             Value v;
+                                             ParseStatus st = w.parse(b.docs[j], v);
+                                             callback(b.first + j, st, v);
+                                         }
+                                         queue.give_back(std::move(b.data));
+                                     } });
+
+        // the calling thread reads, a block is handed over once it is full or at the end of the input
+        std::vector<char> buf;
+        size_t len = 0; // the unfinished last line of the previous block is kept at the front
+        size_t cap = NDJSON_READ_BLOCK;
+        size_t next_index = 0;
+        bool ok = true, eof = false;
+        while (!eof)
+        {
+            if (buf.size() < cap + PARSE_PADDING)
+                buf.resize(cap + PARSE_PADDING);
+            while (len < cap)
+            {
+                ssize_t got = ::read(fd, buf.data() + len, cap - len);
+                if (got < 0 && errno == EINTR)
+                    continue;
+                if (got <= 0)
+                {
+                    ok = got == 0;
+                    eof = true;
+                    break;
+                }
+                len += got;
+            }
+            // a failed read leaves the last line unfinished, it is dropped instead of parsed
+            size_t cut = len;
+            if (!eof || !ok)
+                while (cut > 0 && buf[cut - 1] != '\n')
+                    cut--;
+            // a line longer than the block grows the buffer in place
+            if (cut == 0 && !eof)
+            {
+                EXTEND_SIZE(cap);
+                continue;
+            }
+
+            // only the unfinished tail moves to the front of the next buffer
+            std::vector<char> next = queue.take();
+            size_t tail = len - cut;
+            cap = NDJSON_READ_BLOCK;
+            while (cap <= tail)
+                EXTEND_SIZE(cap);
+            if (next.size() < cap + PARSE_PADDING)
+                next.resize(cap + PARSE_PADDING);
+            if (tail != 0)
+                std::memcpy(next.data(), buf.data() + cut, tail);
+            len = tail;
+
+            __ndjson_batch b;
+            split_lines(buf.data(), buf.data() + cut, b.docs);
+            b.data = std::move(buf); // the views stay valid, the storage moves with the vector
+            b.first = next_index;
+            next_index += b.docs.size();
+            if (!b.docs.empty())
+                queue.push(std::move(b));
+            else
+                queue.give_back(std::move(b.data));
+            buf = std::move(next);
+        }
+        queue.close();
+        for (auto &t : threads)
+            t.join();
+        return ok;
+    }
+
+#pragma endregion
+
+#pragma region tape
+
+    static_assert(TAPE_TAGS[TAPE_CODE_NULL] == 'n' && TAPE_TAGS[TAPE_CODE_FALSE] == 'f' && TAPE_TAGS[TAPE_CODE_TRUE] == 't' &&
+                      TAPE_TAGS[TAPE_CODE_STRING] == '"' && TAPE_TAGS[TAPE_CODE_ARRAY] == '[' &&
+                      TAPE_TAGS[TAPE_CODE_ARRAY_END] == ']' && TAPE_TAGS[TAPE_CODE_OBJECT] == '{' &&
+                      TAPE_TAGS[TAPE_CODE_OBJECT_END] == '}' && TAPE_TAGS[TAPE_CODE_INT] == 'i' &&
+                      TAPE_TAGS[TAPE_CODE_INT64] == 'l' && TAPE_TAGS[TAPE_CODE_UINT64] == 'u',
+                  "tape codes must index their tags");
+
+    // fills a Tape from parse events, open containers remember their start word
+    class __tape_builder final : public SaxHandler
+    {
+        struct frame
+        {
+            size_t start, count;
+            bool is_array;
+        };
+
+        Tape &out;
+        std::vector<frame> open;
+
+        bool element()
+        {
+            if (!open.empty() && open.back().is_array)
+                open.back().count++;
+            return true;
+        }
+
+        bool start(bool is_array)
+        {
+            element();
+            open.push_back(frame{out.words.size(), 0, is_array});
+            out.words.push_back(0);
+            return true;
+        }
+
+        bool close(unsigned open_code, unsigned close_code)
+        {
+            frame f = open.back();
+            open.pop_back();
+            out.words.push_back(TAPE_WORD(close_code, f.start));
+            size_t count = f.count < TAPE_COUNT_MAX ? f.count : TAPE_COUNT_MAX;
+            out.words[f.start] = TAPE_WORD(open_code, (uint64_t(count) << TAPE_END_BITS) | out.words.size());
+            return true;
+        }
+
+        // wide integers take the word after their tag
+        bool number_word(unsigned code, uint64_t bits)
+        {
+            element();
+            out.words.push_back(TAPE_WORD(code, 0));
+            out.words.push_back(bits);
+            return true;
+        }
+
+    public:
+        explicit __tape_builder(Tape &out) : out(out) {}
+
+        bool null() override
+        {
+            out.words.push_back(TAPE_WORD(TAPE_CODE_NULL, 0));
+            return element();
+        }
+
+        bool boolean(bool v) override
+        {
+            out.words.push_back(TAPE_WORD(v ? TAPE_CODE_TRUE : TAPE_CODE_FALSE, 0));
+            return element();
+        }
+
+        bool number(double v) override
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            out.words.push_back(bits);
+            return element();
+        }
+
+        bool int64(int64_t v) override
+        {
+            if (v < -(int64_t(1) << (TAPE_INT_BITS - 1)) || v >= (int64_t(1) << (TAPE_INT_BITS - 1)))
+                return number_word(TAPE_CODE_INT64, uint64_t(v));
+            out.words.push_back(TAPE_WORD(TAPE_CODE_INT, TAPE_PAYLOAD(uint64_t(v))));
+            return element();
+        }
+
+        bool uint64(uint64_t v) override
+        {
+            if (v >= uint64_t(1) << (TAPE_INT_BITS - 1))
+                return number_word(TAPE_CODE_UINT64, v);
+            out.words.push_back(TAPE_WORD(TAPE_CODE_INT, v));
+            return element();
+        }
+
+        bool string(std::string_view v) override
+        {
+            out.words.push_back(TAPE_WORD(TAPE_CODE_STRING, out.strings.size()));
+            out.push_string(v.data(), v.size());
+            return element();
+        }
+
+        // duplicate keys are all kept, lookups find the first one like in a Value
+        bool key(std::string_view k) override
+        {
+            open.back().count++;
+            out.words.push_back(TAPE_WORD(TAPE_CODE_STRING, out.strings.size()));
+            out.push_string(k.data(), k.size());
+            return true;
+        }
+
+        bool start_object() override { return start(false); }
+        bool end_object() override { return close(TAPE_CODE_OBJECT, TAPE_CODE_OBJECT_END); }
+        bool start_array() override { return start(true); }
+        bool end_array() override { return close(TAPE_CODE_ARRAY, TAPE_CODE_ARRAY_END); }
+    };
+
+    void Tape::push_string(const char *p, size_t n)
+    {
+        // a 32-bit length, then the bytes
+        uint32_t len = uint32_t(n);
+        size_t at = strings.size();
+        strings.resize(at + sizeof(len) + n);
+        std::memcpy(strings.data() + at, &len, sizeof(len));
+        std::memcpy(strings.data() + at + sizeof(len), p, n);
+    }
+
+    ParseStatus Tape::parse(const char *data, size_t len, const ParseOptions &opts)
+    {
+        reset();
+        __tape_builder builder(*this);
+        auto status = parse_sax(std::string_view(data, len), builder, opts);
+        if (status != ParseStatus::OK)
+            reset();
+        return status;
+    }
+
+    ParseStatus Tape::parse(std::string_view input, const ParseOptions &opts)
+    {
+        return parse(input.data(), input.size(), opts);
+    }
+
+    TapeValue Tape::root() const
+    {
+        return words.empty() ? TapeValue() : TapeValue(this, 0);
+    }
+
+    void Tape::reset()
+    {
+        words.clear();
+        strings.clear();
+    }
+
+    size_t Tape::bytes() const { return words.size() * sizeof(uint64_t) + strings.size(); }
+
+    TapeValue::TapeValue() : tape(nullptr), pos(0) {}
+
+    TapeValue::TapeValue(const Tape *tape, size_t pos) : tape(tape), pos(pos) {}
+
+    char TapeValue::tag() const { return tape != nullptr ? TAPE_TAG(tape->words[pos]) : '\0'; }
+
+    uint64_t TapeValue::payload() const { return TAPE_PAYLOAD(tape->words[pos]); }
+
+    size_t TapeValue::next() const
+    {
+        // doubles first, the most common word of numeric arrays
+        if (tape != nullptr && (tape->words[pos] & TAPE_BOX) != TAPE_BOX)
+            return pos + 1;
+        switch (tag())
+        {
+        case '[':
+        case '{':
+            return TAPE_END(tape->words[pos]);
+        case 'l':
+        case 'u':
+            return pos + 2;
+        default:
+            return pos + 1;
+        }
+    }
+
+    ValueType TapeValue::get_type() const
+    {
+        switch (tag())
+        {
+        case 'n':
+            return ValueType::Null;
+        case 't':
+        case 'f':
+            return ValueType::Bool;
+        case 'i':
+        case 'l':
+        case 'u':
+        case 'd':
+            return ValueType::Number;
+        case '"':
+            return ValueType::String;
+        case '[':
+            return ValueType::Array;
+        case '{':
+            return ValueType::Object;
+        default:
+            return ValueType::None;
+        }
+    }
+
+    size_t TapeValue::get_size() const
+    {
+        size_t n = 0;
+        switch (tag())
+        {
+        case '"':
+            return as_string_view().size();
+        case '[':
+            if (TAPE_COUNT(tape->words[pos]) < TAPE_COUNT_MAX)
+                return TAPE_COUNT(tape->words[pos]);
+            for (auto it = array_begin(); it != array_end(); ++it)
+                n++;
+            return n;
+        case '{':
+            if (TAPE_COUNT(tape->words[pos]) < TAPE_COUNT_MAX)
+                return TAPE_COUNT(tape->words[pos]);
+            for (auto it = object_begin(); it != object_end(); ++it)
+                n++;
+            return n;
+        default:
+            return 0;
+        }
+    }
+
+    bool TapeValue::is_none() const { return tag() == '\0'; }
+
+    bool TapeValue::is_null() const { return tag() == 'n'; }
+
+    bool TapeValue::is_bool() const { return tag() == 't' || tag() == 'f'; }
+
+    bool TapeValue::is_number() const
+    {
+        char t = tag();
+        return t == 'd' || t == 'i' || t == 'l' || t == 'u';
+    }
+
+    bool TapeValue::is_int64() const { return tag() == 'i' || tag() == 'l'; }
+
+    bool TapeValue::is_uint64() const { return tag() == 'u' || (is_int64() && as_int64() >= 0); }
+
+    bool TapeValue::is_string() const { return tag() == '"'; }
+
+    bool TapeValue::is_array() const { return tag() == '['; }
+
+    bool TapeValue::is_object() const { return tag() == '{'; }
+
+    bool TapeValue::as_bool() const { return tag() == 't'; }
+
+    double TapeValue::as_number() const
+    {
+        uint64_t w = tape->words[pos];
+        double d;
+        switch (TAPE_TAG(w))
+        {
+        case 'd':
+            std::memcpy(&d, &w, sizeof(d));
+            return d;
+        case 'i':
+            return double(TAPE_INT(w));
+        case 'l':
+            return double(int64_t(tape->words[pos + 1]));
+        case 'u':
+            return double(tape->words[pos + 1]);
+        default:
+            return 0;
+        }
+    }
+
+    int64_t TapeValue::as_int64() const
+    {
+        uint64_t w = tape->words[pos];
+        switch (TAPE_TAG(w))
+        {
+        case 'i':
+            return TAPE_INT(w);
+        case 'l':
+            return int64_t(tape->words[pos + 1]);
+        case 'u':
+            return tape->words[pos + 1] > uint64_t(INT64_MAX) ? INT64_MAX : int64_t(tape->words[pos + 1]);
+        default:
+            return double_to_int64(as_number());
+        }
+    }
+
+    uint64_t TapeValue::as_uint64() const
+    {
+        switch (tag())
+        {
+        case 'u':
+            return tape->words[pos + 1];
+        case 'i':
+        case 'l':
+        {
+            int64_t n = as_int64();
+            return n < 0 ? 0 : uint64_t(n);
+        }
+        default:
+            return double_to_uint64(as_number());
+        }
+    }
+
+    std::string_view TapeValue::as_string_view() const
+    {
+        const char *p = tape->strings.data() + payload();
+        uint32_t len;
+        std::memcpy(&len, p, sizeof(len));
+        return std::string_view(p + sizeof(len), len);
+    }
+
+    TapeValue TapeValue::operator[](std::string_view k) const
+    {
+        if (tag() != '{')
+            return TapeValue();
+        for (auto it = object_begin(); it != object_end(); ++it)
+        {
+            if (it->first == k)
+                return it->second;
+        }
+        return TapeValue();
+    }
+
+    TapeValue TapeValue::operator[](size_t idx) const
+    {
+        if (tag() != '[')
+            return TapeValue();
+        auto it = array_begin();
+        for (; idx > 0 && it != array_end(); idx--)
+            ++it;
+        return it != array_end() ? *it : TapeValue();
+    }
+
+    // the closing word of a container sits right before the position it records
+    TapeValue::array_iterator TapeValue::array_begin() const { return array_iterator(tape, pos + 1); }
+    TapeValue::array_iterator TapeValue::array_end() const { return array_iterator(tape, next() - 1); }
+    TapeValue::object_iterator TapeValue::object_begin() const { return object_iterator(tape, pos + 1); }
+    TapeValue::object_iterator TapeValue::object_end() const { return object_iterator(tape, next() - 1); }
+
+    __tape_array_iterator::__tape_array_iterator() {}
+
+    __tape_array_iterator::__tape_array_iterator(const Tape *tape, size_t pos) : cur(tape, pos) {}
+
+    const TapeValue &__tape_array_iterator::operator*() const { return cur; }
+
+    const TapeValue *__tape_array_iterator::operator->() const { return &cur; }
+
+    __tape_array_iterator &__tape_array_iterator::operator++()
+    {
+        cur.pos = cur.next();
+        return *this;
+    }
+
+    __tape_array_iterator __tape_array_iterator::operator++(int)
+    {
+        self_type tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    bool __tape_array_iterator::operator==(const self_type &another) const { return cur.pos == another.cur.pos; }
+
+    bool __tape_array_iterator::operator!=(const self_type &another) const { return cur.pos != another.cur.pos; }
+
+    __tape_object_iterator::__tape_object_iterator() : tape(nullptr), pos(0) {}
+
+    __tape_object_iterator::__tape_object_iterator(const Tape *tape, size_t pos) : tape(tape), pos(pos) { load(); }
+
+    void __tape_object_iterator::load()
+    {
+        if (TAPE_TAG(tape->words[pos]) == '}')
+            return;
+        cur.first = TapeValue(tape, pos).as_string_view();
+        cur.second = TapeValue(tape, pos + 1);
+    }
+
+    const __tape_object_iterator::member_type &__tape_object_iterator::operator*() const { return cur; }
+
+    const __tape_object_iterator::member_type *__tape_object_iterator::operator->() const { return &cur; }
+
+    __tape_object_iterator &__tape_object_iterator::operator++()
+    {
+        pos = cur.second.next();
+        load();
+        return *this;
+    }
+
+    __tape_object_iterator __tape_object_iterator::operator++(int)
+    {
+        self_type tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    bool __tape_object_iterator::operator==(const self_type &another) const { return pos == another.pos; }
+
+    bool __tape_object_iterator::operator!=(const self_type &another) const { return pos != another.pos; }
+
+#pragma endregion
+
+#pragma region serializer
+
+    Value::string_type Value::dump(const DumpOptions &opts) const
+    {
+        string_type out;
+        if (opts.exact_size)
+        {
+            out.resize(dump_size(opts));
+            __writer w(nullptr, out.data(), out.size(), opts);
+            w.write_value(*this, 0);
+            return out;
+        }
+        out.resize(DUMP_INIT_CAP);
+        __writer w(&out, out.data(), out.size(), opts);
+        w.write_value(*this, 0);
+        w.finish();
+        return out;
+    }
+
+    size_t Value::dump_size(const DumpOptions &opts) const
+    {
+        return __writer::measure_value(*this, 0, opts);
+    }
+
+    size_t Value::dump(char *buf, size_t cap, const DumpOptions &opts) const
+    {
+        size_t n = dump_size(opts);
+        if (n <= cap)
+        {
+            __writer w(nullptr, buf, cap, opts);
+            w.write_value(*this, 0);
+        }
+        return n;
+    }
+
+    __writer::__writer(std::string *str, char *buf, size_t cap, const DumpOptions &opts)
+        : str(str), cur(buf), end(buf + cap), opts(opts) {}
+
+    char *__writer::reserve(size_t n)
+    {
+        // a measured buffer always has room for what is actually written
+        if (str != nullptr && size_t(end - cur) < n)
+        {
+            size_t used = cur - str->data(), cap = str->size();
+            do
+                EXTEND_SIZE(cap);
+            while (cap - used < n);
+            str->resize(cap);
+            cur = str->data() + used;
+            end = str->data() + cap;
+        }
+        return cur;
+    }
+
+    void __writer::put(char c)
+    {
+        *reserve(1) = c;
+        cur++;
+    }
+
+    void __writer::write_raw(const char *p, size_t n)
+    {
+        std::memcpy(reserve(n), p, n);
+        cur += n;
+    }
+
+    void __writer::finish()
+    {
+        str->resize(cur - str->data());
+    }
+
+    size_t __writer::measure_value(const Value &v, unsigned depth, const DumpOptions &opts)
+    {
+        char buf[DUMP_NUMBER_MAX];
+        size_t n, newline = opts.indent ? 1 + size_t(opts.indent) * (depth + 1) : 0;
+        switch (v.type)
+        {
+        case ValueType::Bool:
+            return v.bool_val ? 4 : 5;
+        case ValueType::Number:
+            return format_number(v, buf);
+        case ValueType::String:
+            return measure_string(v.as_string_view());
+        case ValueType::Array:
+            if (v.parray->empty())
+                return 2;
+            // brackets, commas, and a line per element plus the closing one
+            n = 2 + v.parray->size() - 1 + v.parray->size() * newline + (newline ? newline - opts.indent : 0);
+            for (auto &e : *v.parray)
+                n += measure_value(e, depth + 1, opts);
+            return n;
+        case ValueType::Object:
+            if (v.pobject->size() == 0)
+                return 2;
+            n = 2 + v.pobject->size() - 1 + v.pobject->size() * (newline + (opts.indent ? 2 : 1)) +
+                (newline ? newline - opts.indent : 0);
+            for (auto &m : *v.pobject)
+                n += measure_string(m.first) + measure_value(m.second, depth + 1, opts);
+            return n;
+        case ValueType::Null:
+        case ValueType::None:
+        default:
+            return 4;
+        }
+    }
+
+    size_t __writer::measure_string(std::string_view s)
+    {
+        const char *p = s.data(), *e = p + s.size();
+        size_t n = 2;
+        while (true)
+        {
+            const char *run = scan_string(p, e, false);
+            n += run - p;
+            if (run == e)
+                return n;
+            switch (*run)
+            {
+            case '"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                n += 2;
+                break;
+            default:
+                n += 6;
+                break;
+            }
+            p = run + 1;
+        }
+    }
+
+    size_t __writer::format_number(const Value &v, char *buf)
+    {
+        switch (v.number_kind)
+        {
+        case Value::NumberKind::Int64:
+            return std::to_chars(buf, buf + DUMP_NUMBER_MAX, v.int_val).ptr - buf;
+        case Value::NumberKind::Uint64:
+            return std::to_chars(buf, buf + DUMP_NUMBER_MAX, v.uint_val).ptr - buf;
+        case Value::NumberKind::Double:
+        default:
+            // json has no nan or infinity
+            if (!std::isfinite(v.number_val))
+            {
+                std::memcpy(buf, "null", 4);
+                return 4;
+            }
+            return std::to_chars(buf, buf + DUMP_NUMBER_MAX, v.number_val).ptr - buf;
+        }
+    }
+
+    void __writer::write_value(const Value &v, unsigned depth)
+    {
+        char buf[DUMP_NUMBER_MAX];
+        bool first = true;
+        switch (v.type)
+        {
+        case ValueType::Bool:
+            if (v.bool_val)
+                write_raw("true", 4);
+            else
+                write_raw("false", 5);
+            break;
+        case ValueType::Number:
+            // a measured buffer has no room to spare
+            write_raw(buf, format_number(v, buf));
+            break;
+        case ValueType::String:
+            write_string(v.as_string_view());
+            break;
+        case ValueType::Array:
+            put('[');
+            if (!v.parray->empty())
+            {
+                for (auto &e : *v.parray)
+                {
+                    if (!first)
+                        put(',');
+                    first = false;
+                    write_newline(depth + 1);
+                    write_value(e, depth + 1);
+                }
+                write_newline(depth);
+            }
+            put(']');
+            break;
+        case ValueType::Object:
+            put('{');
+            if (v.pobject->size() != 0)
+            {
+                for (auto &m : *v.pobject)
+                {
+                    if (!first)
+                        put(',');
+                    first = false;
+                    write_newline(depth + 1);
+                    write_string(m.first);
+                    put(':');
+                    if (opts.indent)
+                        put(' ');
+                    write_value(m.second, depth + 1);
+                }
+                write_newline(depth);
+            }
+            put('}');
+            break;
+        case ValueType::Null:
+        case ValueType::None:
+        default:
+            write_raw("null", 4);
+            break;
+        }
+    }
+
+    void __writer::write_string(std::string_view s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        const char *p = s.data(), *e = p + s.size();
+        put('"');
+        while (true)
+        {
+            // clean runs up to the next byte that needs escaping are copied at once
+            const char *run = scan_string(p, e, false);
+            if (run != p)
+                write_raw(p, run - p);
+            if (run == e)
+                break;
+            unsigned char c = *run;
+            char *o = reserve(6);
+            o[0] = '\\';
+            switch (c)
+            {
+            case '"':
+            case '\\':
+                o[1] = c;
+                break;
+            case '\b':
+                o[1] = 'b';
+                break;
+            case '\f':
+                o[1] = 'f';
+                break;
+            case '\n':
+                o[1] = 'n';
+                break;
+            case '\r':
+                o[1] = 'r';
+                break;
+            case '\t':
+                o[1] = 't';
+                break;
+            default:
+                o[1] = 'u', o[2] = '0', o[3] = '0';
+                o[4] = hex[c >> 4], o[5] = hex[c & 0xF];
+                cur += 4;
+                break;
+            }
+            cur += 2;
+            p = run + 1;
+        }
+        put('"');
+    }
+
+    void __writer::write_newline(unsigned depth)
+    {
+        if (opts.indent == 0)
+            return;
+        size_t n = 1 + size_t(opts.indent) * depth;
+        char *p = reserve(n);
+        p[0] = '\n';
+        std::memset(p + 1, ' ', n - 1);
+        cur += n;
+    }
+
+#pragma endregion
+
+#pragma region string pool
+
+    StringPool::StringPool(size_t max_value) : count(0), total(0), max_value(max_value) {}
+
+    void StringPool::grow()
+    {
+        std::vector<std::string_view> old(slots.empty() ? INTERN_INIT_SLOTS : slots.size() * 2);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (auto &s : old)
+        {
+            if (s.data() == nullptr)
+                continue;
+            size_t slot = std::hash<std::string_view>()(s) & mask;
+            while (slots[slot].data() != nullptr)
+                slot = (slot + 1) & mask;
+            slots[slot] = s;
+        }
+    }
+
+    std::string_view StringPool::intern(std::string_view s)
+    {
+        if (s.empty())
+            return std::string_view("", 0);
+        size_t hash = std::hash<std::string_view>()(s);
+        std::lock_guard<std::mutex> guard(lock);
+        if ((count + 1) * 2 > slots.size())
+            grow();
+        size_t mask = slots.size() - 1, slot = hash & mask;
+        for (; slots[slot].data() != nullptr; slot = (slot + 1) & mask)
+        {
+            if (slots[slot] == s)
+                return slots[slot];
+        }
+        char *p = (char *)storage.allocate(s.size(), 1);
+        std::memcpy(p, s.data(), s.size());
+        slots[slot] = std::string_view(p, s.size());
+        count++;
+        total += s.size();
+        return slots[slot];
+    }
+
+    size_t StringPool::size() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return count;
+    }
+
+    size_t StringPool::bytes() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return total;
+    }
+
+    void StringPool::clear()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::fill(slots.begin(), slots.end(), std::string_view());
+        storage.release();
+        count = 0;
+        total = 0;
+    }
+
+#pragma endregion
+
+#pragma region reusable parser
+
+    Parser::Parser(size_t retain_limit)
+        : ps(new __parser(nullptr, 0, ParseOptions())), retain_limit(retain_limit) {}
+
+    Parser::~Parser()
+    {
+        delete ps;
+    }
+
+    __parser &Parser::prepare(const char *data, size_t len, const ParseOptions &opts, std::pmr::memory_resource *arena)
+    {
+        ps->raw_begin = ps->raw_iter = data;
+        ps->raw_end = data + len;
+        ps->opts = opts;
+        ps->arena = arena;
+        ps->cstack.set_top(0);
+        return *ps;
+    }
+
+    ParseStatus Parser::done(ParseStatus status)
+    {
+        st.documents++;
+        st.stack_bytes = ps->cstack.get_capacity();
+        st.index_bytes = ps->index.capacity() * sizeof(uint32_t);
+        st.frame_bytes = ps->frames.capacity() * sizeof(__parse_frame);
+        st.peak_stack_bytes = std::max(st.peak_stack_bytes, st.stack_bytes);
+        st.peak_index_bytes = std::max(st.peak_index_bytes, st.index_bytes);
+        st.peak_frame_bytes = std::max(st.peak_frame_bytes, st.frame_bytes);
+        if (st.stack_bytes + st.index_bytes + st.frame_bytes > retain_limit)
+        {
+            shrink();
+            st.shrinks++;
+        }
+        return status;
+    }
+
+    std::pair<ParseStatus, json> Parser::parse(const char *data, size_t len, const ParseOptions &opts)
+    {
+        Value result;
+        auto status = prepare(data, len, opts, nullptr).exec(result);
+        return {done(status), std::move(result)};
+    }
+
+    std::pair<ParseStatus, json> Parser::parse(std::string_view input, const ParseOptions &opts)
+    {
+        return parse(input.data(), input.size(), opts);
+    }
+
+    ParseStatus Parser::parse(std::string_view input, Document &doc, const ParseOptions &opts)
+    {
+        doc.reset();
+        return done(doc.build(prepare(input.data(), input.size(), opts, &doc.arena)));
+    }
+
+    ParseStatus Parser::parse(std::string_view input, Tape &tape, const ParseOptions &opts)
+    {
+        tape.reset();
+        __tape_builder builder(tape);
+        auto status = prepare(input.data(), input.size(), opts, nullptr).exec(builder);
+        if (status != ParseStatus::OK)
+            tape.reset();
+        return done(status);
+    }
+
+    ParseStatus Parser::parse_sax(std::string_view input, SaxHandler &handler, const ParseOptions &opts)
+    {
+        return done(prepare(input.data(), input.size(), opts, nullptr).exec(handler));
+    }
+
+    const ParserStats &Parser::stats() const { return st; }
+
+    void Parser::set_retain_limit(size_t bytes) { retain_limit = bytes; }
+
+    void Parser::shrink()
+    {
+        ps->cstack.shrink();
+        ps->index.clear();
+        ps->index.shrink_to_fit();
+        ps->frames.clear();
+        ps->frames.shrink_to_fit();
+        st.stack_bytes = ps->cstack.get_capacity();
+        st.index_bytes = 0;
+        st.frame_bytes = 0;
+    }
+
+#pragma endregion
+
+#pragma region file
+
+    __mapped_file::~__mapped_file()
+    {
+        unmap();
+    }
+
+    // the file is mapped over the start of a larger anonymous mapping, so the padding behind
+    // it reads as zeros instead of faulting like pages past the end of a file would
+    bool __mapped_file::map(const char *path)
+    {
+        unmap();
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            ::close(fd);
+            return false;
+        }
+        size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        len = size_t(st.st_size);
+        map_len = (len + PARSE_PADDING + page - 1) / page * page;
+        base = ::mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        bool ok = base != MAP_FAILED;
+        if (ok && len != 0)
+        {
+            ok = ::mmap(base, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED;
+            if (ok)
+                ::madvise(base, len, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        if (!ok)
+        {
+            if (base != MAP_FAILED)
+                ::munmap(base, map_len);
+            base = nullptr;
+            map_len = len = 0;
+        }
+        return ok;
+    }
+
+    void __mapped_file::unmap()
+    {
+        if (base != nullptr)
+            ::munmap(base, map_len);
+        base = nullptr;
+        map_len = len = 0;
+    }
+
+    const char *__mapped_file::data() const { return (const char *)base; }
+
+    size_t __mapped_file::size() const { return len; }
+
+    std::pair<ParseStatus, json> parse_file(const char *path, const ParseOptions &opts)
+    {
+        __mapped_file file;
+        if (!file.map(path))
+            return {ParseStatus::FILE_UNREADABLE, Value()};
+        ParseOptions mapped = opts;
+        mapped.padded = true;
+        mapped.borrow_strings = false;
+        return parse(file.data(), file.size(), mapped);
+    }
+
+#pragma endregion
+
+#pragma region document
+
+    Document::Document(size_t initial_arena)
+        : initial_chunk(new char[initial_arena]), arena(initial_chunk.get(), initial_arena) {}
+
+    // root_value only points into the arena, so nothing is freed node by node
+    Document::~Document() = default;
+
+    ParseStatus Document::parse(const char *data, size_t len, const ParseOptions &opts)
+    {
+        reset();
+        __parser ps(data, len, opts, &arena);
+        return build(ps);
+    }
+
+    ParseStatus Document::build(__parser &ps)
+    {
+        auto status = ps.exec(root_value);
+        if (status != ParseStatus::OK)
+            root_value.set_literal(ValueType::None);
+        return status;
+    }
+
+    ParseStatus Document::parse(std::string_view input, const ParseOptions &opts)
+    {
+        return parse(input.data(), input.size(), opts);
+    }
+
+    ParseStatus Document::parse_file(const char *path, const ParseOptions &opts)
+    {
+        reset();
+        if (!file.map(path))
+            return ParseStatus::FILE_UNREADABLE;
+        ParseOptions mapped = opts;
+        mapped.padded = true;
+        __parser ps(file.data(), file.size(), mapped, &arena);
+        auto status = build(ps);
+        // nothing points into the file any more
+        if (status != ParseStatus::OK || !opts.borrow_strings)
+            file.unmap();
+        return status;
+    }
+
+    const Value &Document::root() const { return root_value; }
+
+    void Document::reset()
+    {
+        root_value.set_literal(ValueType::None);
+        arena.release();
+        file.unmap();
+    }
+
+#pragma endregion
+
+}
@@ -1,27 +1,127 @@
 #ifndef _EZJSON_H__
 #define _EZJSON_H__
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <map>
 
 namespace kkjson
 {
-    enum class ValueType;
+    enum class ValueType : unsigned char;
     enum class ParseStatus;
     class Value;
+    class Document;
+    class Tape;
+    class TapeValue;
+    class LazyValue;
+    class SaxHandler;
+    class StreamParser;
+    class Parser;
+    class Query;
+    class StringPool;
 
     struct __char_stack;
     class __parser;
-    class __array_iterator;  // random
+    class __writer;
+    class __tape_builder;
+    class __dom_builder;
+    class __ndjson_worker;
+    class __mapped_file;
+    class __object;
+    template <class T>
+    class __array_iterator; // random
+    template <class T>
     class __object_iterator; // bidirect
+    class __tape_array_iterator;  // forward
+    class __tape_object_iterator; // forward
+    class __lazy_array_iterator;  // forward
 
     using json = Value;
 
+    // number of readable bytes a padded input must provide after its last byte
+    constexpr size_t PARSE_PADDING = 64;
+    // size of the first arena chunk a Document allocates up front and keeps across parses
+    constexpr size_t DOCUMENT_INITIAL_ARENA = 64 * 1024;
+    // scratch memory a Parser keeps after a parse by default, more is released again
+    constexpr size_t PARSER_RETAIN_LIMIT = 1024 * 1024;
+    // strings up to this many bytes are stored inside their Value, without an allocation
+    constexpr size_t SMALL_STRING_MAX = 12;
+    // containers a document may nest by default
+    constexpr unsigned PARSE_MAX_DEPTH = 1024;
+    // longest string value a StringPool interns by default, keys are interned at any length
+    constexpr size_t INTERN_MAX_VALUE = 32;
+
+    struct ParseOptions
+    {
+        // the caller guarantees that PARSE_PADDING bytes after the input are readable,
+        // so the scanning loops may load whole blocks across the end. their contents are ignored.
+        bool padded = false;
+        // strings without escapes are not copied but point into the input,
+        // which then has to outlive the result and every copy of its strings.
+        bool borrow_strings = false;
+        // two-stage parse: a SIMD pass indexes the structural characters first, then the tree
+        // is built by walking the index. results and errors are the same as the default engine.
+        bool structural_index = false;
+        // a large top-level array is split at its commas and the parts are parsed on up to this
+        // many threads, 0 starts one per hardware thread. only parse() splits, the result is the same.
+        unsigned threads = 1;
+        // object keys and string values up to its limit are taken from this pool instead of being copied,
+        // which then has to outlive the result like the input with borrow_strings.
+        // StreamParser and Tape keep their own copies.
+        StringPool *intern = nullptr;
+        // a container opened deeper than this fails with DEPTH_EXCEEDED. the tree parse keeps its
+        // open containers on the heap, the limit bounds the stack of the scanners that recurse.
+        unsigned max_depth = PARSE_MAX_DEPTH;
+    };
+
+    struct DumpOptions
+    {
+        // spaces per nesting level, 0 writes everything on one line without spaces
+        unsigned indent = 0;
+        // measure the output first so that the string is allocated exactly once
+        bool exact_size = false;
+    };
+
+    struct NdjsonOptions
+    {
+        // worker threads, 0 starts one per hardware thread
+        unsigned threads = 0;
+        // batches of whole lines the reader of parse_ndjson_fd may be ahead of the workers
+        unsigned queue_depth = 8;
+        // borrow_strings is ignored by parse_ndjson_fd, its buffers do not outlive the callback
+        ParseOptions parse;
+    };
+
+    // gets the index of a document among the non-blank lines, its status and its value.
+    // runs on the worker threads, concurrently and in no particular order.
+    using NdjsonCallback = std::function<void(size_t index, ParseStatus status, json &value)>;
+
     std::pair<ParseStatus, json> parse(const char *str);
+    std::pair<ParseStatus, json> parse(const char *data, size_t len, const ParseOptions &opts = ParseOptions());
+    std::pair<ParseStatus, json> parse(std::string_view input, const ParseOptions &opts = ParseOptions());
+    // checks the input with the grammar and error codes of parse(), but builds, decodes and
+    // allocates nothing. the offset is where the error was found, or the input size.
+    std::pair<ParseStatus, size_t> validate(std::string_view input, const ParseOptions &opts = ParseOptions());
+    // maps the file instead of reading it, strings are always copied out of the mapping
+    std::pair<ParseStatus, json> parse_file(const char *path, const ParseOptions &opts = ParseOptions());
+    // newline-delimited documents, one per line. blank lines are skipped.
+    std::vector<std::pair<ParseStatus, json>> parse_ndjson(std::string_view input, const NdjsonOptions &opts = NdjsonOptions());
+    void parse_ndjson(std::string_view input, const NdjsonCallback &callback, const NdjsonOptions &opts = NdjsonOptions());
+    // reads fd to its end while the workers parse what was read so far. false on a read error,
+    // the line it cut off is dropped.
+    bool parse_ndjson_fd(int fd, const NdjsonCallback &callback, const NdjsonOptions &opts = NdjsonOptions());
+    // only finds the root value, everything else is parsed when it is accessed
+    std::pair<ParseStatus, LazyValue> parse_lazy(std::string_view input, const ParseOptions &opts = ParseOptions());
 
-    enum class ValueType
+    enum class ValueType : unsigned char
     {
         None,
         Null,
@@ -51,38 +151,155 @@ namespace kkjson
         MISS_ARRAY_SYMBOL,
         // object
         MISS_OBJECT_KEY,
-        MISS_OBJECT_SYMBOL
+        MISS_OBJECT_SYMBOL,
+        // sax
+        ABORTED,
+        // file
+        FILE_UNREADABLE,
+        // query
+        INVALID_PATH,
+        // nesting
+        DEPTH_EXCEEDED
+    };
+
+    // receives the values of a document in order while it is parsed, without a tree being built.
+    // returning false from any event stops the parse with ParseStatus::ABORTED. events already
+    // delivered stand even if the input turns out to be invalid further on.
+    class SaxHandler
+    {
+    public:
+        virtual ~SaxHandler() = default;
+
+        virtual bool null() = 0;
+        virtual bool boolean(bool v) = 0;
+        virtual bool number(double v) = 0;
+        // integer tokens that fit, reported as number() unless overridden
+        virtual bool int64(int64_t v) { return number(double(v)); }
+        virtual bool uint64(uint64_t v) { return number(double(v)); }
+        // strings and keys are only valid during the call
+        virtual bool string(std::string_view v) = 0;
+        virtual bool key(std::string_view k) = 0;
+        virtual bool start_object() = 0;
+        virtual bool end_object() = 0;
+        virtual bool start_array() = 0;
+        virtual bool end_array() = 0;
+    };
+
+    ParseStatus parse_sax(std::string_view input, SaxHandler &handler, const ParseOptions &opts = ParseOptions());
+
+    template <class Handler, class = void>
+    struct __sax_has_int64 : std::false_type
+    {
+    };
+    template <class Handler>
+    struct __sax_has_int64<Handler, std::void_t<decltype(std::declval<Handler &>().int64(int64_t()),
+                                                         std::declval<Handler &>().uint64(uint64_t()))>>
+        : std::true_type
+    {
     };
 
+    // lets any class with the SaxHandler member functions be used as one
+    template <class Handler>
+    class __sax_adapter final : public SaxHandler
+    {
+        Handler &h;
+
+    public:
+        explicit __sax_adapter(Handler &h) : h(h) {}
+
+        bool null() override { return h.null(); }
+        bool boolean(bool v) override { return h.boolean(v); }
+        bool number(double v) override { return h.number(v); }
+        bool int64(int64_t v) override
+        {
+            if constexpr (__sax_has_int64<Handler>::value)
+                return h.int64(v);
+            else
+                return h.number(double(v));
+        }
+        bool uint64(uint64_t v) override
+        {
+            if constexpr (__sax_has_int64<Handler>::value)
+                return h.uint64(v);
+            else
+                return h.number(double(v));
+        }
+        bool string(std::string_view v) override { return h.string(v); }
+        bool key(std::string_view k) override { return h.key(k); }
+        bool start_object() override { return h.start_object(); }
+        bool end_object() override { return h.end_object(); }
+        bool start_array() override { return h.start_array(); }
+        bool end_array() override { return h.end_array(); }
+    };
+
+    template <class Handler, class = std::enable_if_t<!std::is_base_of_v<SaxHandler, Handler>>>
+    ParseStatus parse_sax(std::string_view input, Handler &handler, const ParseOptions &opts = ParseOptions())
+    {
+        __sax_adapter<Handler> adapter(handler);
+        return parse_sax(input, static_cast<SaxHandler &>(adapter), opts);
+    }
+
     class Value
     {
     private:
         friend class __parser;
+        friend class __object;
+        friend class Document;
+        friend class __writer;
+        friend class __dom_builder;
         using bool_type = bool;
         using number_type = double;
+        using int64_type = int64_t;
+        using uint64_type = uint64_t;
         using string_type = std::string;
-        using array_type = std::vector<Value>;
-        using object_type = std::map<string_type, Value>;
-        using pair_type = std::pair<string_type, Value>;
+        // containers take their memory from a Document arena or, by default, from the heap
+        using array_type = std::pmr::vector<Value>;
+        using object_type = __object;
+        using member_type = std::pair<const std::string_view, Value>;
+        using pair_type = std::pair<const string_type, Value>;
         using init_array_type = std::initializer_list<Value>;
-        using init_obj_type = std::initializer_list<object_type::value_type>;
+        using init_obj_type = std::initializer_list<pair_type>;
+
+        // where the payload of a string lives
+        enum class Storage : unsigned char
+        {
+            Heap,
+            Borrowed, // pview/view_size into the parsed input
+            Arena,    // allocated from a Document arena, released with it
+            Inline    // small_size bytes from view_size on, inside the value itself
+        };
 
-        ValueType type;
+        // how a number is held, integer tokens keep their exact value
+        enum class NumberKind : unsigned char
+        {
+            Double,
+            Int64,
+            Uint64 // only for values above INT64_MAX
+        };
+
+        ValueType type = ValueType::None;
+        Storage storage = Storage::Heap;
+        NumberKind number_kind = NumberKind::Double;
+        uint8_t small_size;
+        uint32_t view_size;
         union // anonymous
         {
             bool_type bool_val;
             number_type number_val;
+            int64_type int_val;
+            uint64_type uint_val;
             string_type *pstring;
             array_type *parray;
             object_type *pobject;
+            const char *pview;
         };
 
     public:
         // iterator retated
-        friend class __array_iterator;
-        friend class __object_iterator;
-        using array_iterator = __array_iterator;
-        using object_iterator = __object_iterator;
+        using array_iterator = __array_iterator<Value>;
+        using const_array_iterator = __array_iterator<const Value>;
+        using object_iterator = __object_iterator<member_type>;
+        using const_object_iterator = __object_iterator<const member_type>;
 
     public:
         Value();
@@ -100,71 +317,150 @@ namespace kkjson
         bool is_null() const;
         bool is_bool() const;
         bool is_number() const;
+        // integer numbers that fit the type without loss
+        bool is_int64() const;
+        bool is_uint64() const;
         bool is_string() const;
         bool is_array() const;
         bool is_object() const;
         // as type
         bool_type &as_bool();
-        number_type &as_number();
+        bool_type as_bool() const;
+        // an integer is converted in the returned copy, the value keeps its exact kind
+        number_type as_number() const;
+        // a double is truncated toward zero, values out of range saturate and NaN gives 0
+        int64_type as_int64() const;
+        uint64_type as_uint64() const;
+        // writes a double, replacing the current value
+        void set_number(number_type n);
+        // a borrowed or inline string is copied into an owned one first,
+        // as_string_view() reads any string without that
         string_type &as_string();
+        std::string_view as_string_view() const;
         // read & write
         Value &operator[](const string_type &k);
         Value &operator[](size_t idx);
+        // a missing key yields a None value
+        const Value &operator[](const string_type &k) const;
+        const Value &operator[](size_t idx) const;
         Value &operator=(bool_type v);
         Value &operator=(number_type n);
+        Value &operator=(int64_type n);
+        Value &operator=(uint64_type n);
         Value &operator=(const string_type &s);
         Value &operator=(const init_array_type &l);
         Value &operator=(const init_obj_type &l);
 
         Value(bool_type v);
         Value(number_type n);
+        Value(int64_type n);
+        Value(uint64_type n);
         Value(const string_type &s);
         Value(const init_array_type &l);
         Value(const init_obj_type &l);
 
+        // serialize, numbers in their shortest round-trip form
+        string_type dump(const DumpOptions &opts = DumpOptions()) const;
+        // exact number of bytes dump() produces
+        size_t dump_size(const DumpOptions &opts = DumpOptions()) const;
+        // writes to buf only when the whole output fits in cap bytes, no terminator is added.
+        // returns the size of the output either way.
+        size_t dump(char *buf, size_t cap, const DumpOptions &opts = DumpOptions()) const;
+
         array_iterator array_begin();
         array_iterator array_end();
+        const_array_iterator array_begin() const;
+        const_array_iterator array_end() const;
+        // members are visited in insertion order
         object_iterator object_begin();
         object_iterator object_end();
+        const_object_iterator object_begin() const;
+        const_object_iterator object_end() const;
 
     private:
         // modify value
         void set_literal(ValueType t);
         void set_bool(bool_type v);
-        void set_number(number_type n);
+        void set_int64(int64_type n);
+        void set_uint64(uint64_type n);
         void set_string(const string_type &another);
         void set_string(const char *p, size_t n);
+        void set_string_view(const char *p, size_t n);
+        void set_string(const char *p, size_t n, std::pmr::memory_resource *arena);
+        void set_small_string(const char *p, size_t n);
+        char *small_data();
+        const char *small_data() const;
         void set_array(const init_array_type &l);
         void set_object(const init_obj_type &l);
 
-        void init_array();
+        void init_array(std::pmr::memory_resource *arena = nullptr);
         void array_push_back(const Value &e);
         void array_push_back(Value &&e);
 
-        void init_object();
+        void init_object(std::pmr::memory_resource *arena = nullptr, StringPool *pool = nullptr);
         void object_insert(const string_type &k, const Value &v);
         void object_insert(const string_type &k, Value &&v);
+        void object_insert(std::string_view k, Value &&v, bool borrow_key = false);
 
         void clear();
     };
 
+    // members in insertion order, found by a linear scan while the object is small
+    // and through a hash index built on demand once it is not
+    class __object
+    {
+        friend class Value;
+        using member_type = Value::member_type;
+
+        std::pmr::vector<member_type> members;
+        std::pmr::vector<uint32_t> index; // open addressing, member position + 1, 0 is empty
+        StringPool *pool;                 // all keys are interned here when set
+        bool owns_keys;                   // keys were copied to the heap and are freed with the object
+
+        const char *copy_key(std::string_view k);
+        void build_index();
+        void index_insert(size_t pos);
+        member_type *find_member(std::string_view k) const;
+
+    public:
+        // keys of an arena object come from the arena or the input and are never freed
+        explicit __object(std::pmr::memory_resource *arena = nullptr, StringPool *pool = nullptr);
+        __object(const __object &another);
+        __object &operator=(const __object &) = delete;
+        ~__object();
+
+        size_t size() const;
+        member_type *begin();
+        member_type *end();
+        const member_type *begin() const;
+        const member_type *end() const;
+
+        Value *find(std::string_view k);
+        const Value *find(std::string_view k) const;
+        // keeps the existing member when k is already there, borrow_key stores k without copying it
+        Value &insert(std::string_view k, Value &&v, bool borrow_key = false);
+    };
+
+    template <class T>
     class __array_iterator
     {
         friend class Value;
-        using inner_iter_type = Value::array_type::iterator; // random iterator
+        template <class U>
+        friend class __array_iterator;
         using self_type = __array_iterator;
-        using difference_type = inner_iter_type::difference_type;
-        using reference = inner_iter_type::reference;
-        using pointer = inner_iter_type::pointer;
+        using difference_type = std::ptrdiff_t;
+        using reference = T &;
+        using pointer = T *;
 
-        inner_iter_type it;
+        pointer it;
 
     public:
         __array_iterator();
         __array_iterator(const self_type &another);
-        __array_iterator(self_type &&another);
-        __array_iterator(const inner_iter_type &it);
-        __array_iterator(inner_iter_type &&it);
+        __array_iterator(pointer it);
+        // iterator to const_iterator
+        template <class U, class = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+        __array_iterator(const __array_iterator<U> &another) : it(another.it) {}
         ~__array_iterator();
 
         reference operator*() const;
@@ -190,22 +486,25 @@ namespace kkjson
         bool operator>=(const self_type &another) const;
     };
 
+    template <class T>
     class __object_iterator
     {
         friend class Value;
-        using inner_iter_type = Value::object_type::iterator; // bidirect iterator
+        template <class U>
+        friend class __object_iterator;
         using self_type = __object_iterator;
-        using reference = inner_iter_type::reference;
-        using pointer = inner_iter_type::pointer;
+        using reference = T &;
+        using pointer = T *;
 
-        inner_iter_type it;
+        pointer it;
 
     public:
         __object_iterator();
         __object_iterator(const self_type &another);
-        __object_iterator(self_type &&another);
-        __object_iterator(const inner_iter_type &it);
-        __object_iterator(inner_iter_type &&it);
+        __object_iterator(pointer it);
+        // iterator to const_iterator
+        template <class U, class = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+        __object_iterator(const __object_iterator<U> &another) : it(another.it) {}
         ~__object_iterator();
 
         reference operator*() const;
@@ -221,6 +520,431 @@ namespace kkjson
         bool operator!=(const self_type &another) const;
     };
 
+    // a file mapped read-only and followed by at least PARSE_PADDING zero bytes
+    class __mapped_file
+    {
+        void *base = nullptr;
+        size_t map_len = 0, len = 0;
+
+    public:
+        __mapped_file() = default;
+        __mapped_file(const __mapped_file &) = delete;
+        __mapped_file &operator=(const __mapped_file &) = delete;
+        ~__mapped_file();
+
+        bool map(const char *path);
+        void unmap();
+        const char *data() const;
+        size_t size() const;
+    };
+
+    // owns every string and container of the tree parsed into it, which is read-only.
+    // destroying or re-parsing drops the whole tree at once instead of node by node.
+    class Document
+    {
+        friend class Parser;
+
+        __mapped_file file; // kept while borrowed strings point into it
+        std::unique_ptr<char[]> initial_chunk;
+        std::pmr::monotonic_buffer_resource arena;
+        Value root_value;
+
+        ParseStatus build(__parser &ps);
+
+    public:
+        explicit Document(size_t initial_arena = DOCUMENT_INITIAL_ARENA);
+        Document(const Document &) = delete;
+        Document &operator=(const Document &) = delete;
+        ~Document();
+
+        ParseStatus parse(const char *data, size_t len, const ParseOptions &opts = ParseOptions());
+        ParseStatus parse(std::string_view input, const ParseOptions &opts = ParseOptions());
+        // the file is mapped, with borrow_strings it stays mapped until the tree is dropped
+        ParseStatus parse_file(const char *path, const ParseOptions &opts = ParseOptions());
+
+        const Value &root() const;
+        // drops the tree, a mapped file and every arena chunk but the initial one
+        void reset();
+    };
+
+    // a parsed document as one array of 64-bit words and a string buffer, read-only.
+    // words are NaN-boxed: a double is the word itself, everything else is tagged inside a NaN,
+    // so most scalars take 8 bytes where a Value takes 16. containers record where they end
+    // so that skipping one is O(1). re-parsing keeps the memory of both buffers.
+    class Tape
+    {
+        friend class __tape_builder;
+        friend class TapeValue;
+        friend class __tape_object_iterator;
+
+        std::vector<uint64_t> words;
+        std::vector<char> strings;
+
+        void push_string(const char *p, size_t n);
+
+    public:
+        ParseStatus parse(const char *data, size_t len, const ParseOptions &opts = ParseOptions());
+        ParseStatus parse(std::string_view input, const ParseOptions &opts = ParseOptions());
+
+        // a None value until a parse succeeded
+        TapeValue root() const;
+        void reset();
+        // bytes the words and strings of the parsed document take
+        size_t bytes() const;
+    };
+
+    // a position in a Tape, cheap to copy and valid as long as the tape is not re-parsed
+    class TapeValue
+    {
+        friend class Tape;
+        friend class __tape_array_iterator;
+        friend class __tape_object_iterator;
+
+        const Tape *tape;
+        size_t pos;
+
+        TapeValue(const Tape *tape, size_t pos);
+        char tag() const;
+        uint64_t payload() const;
+        // the word after this value
+        size_t next() const;
+
+    public:
+        using array_iterator = __tape_array_iterator;
+        using object_iterator = __tape_object_iterator;
+
+        TapeValue();
+
+        ValueType get_type() const;
+        size_t get_size() const;
+        bool is_none() const;
+        bool is_null() const;
+        bool is_bool() const;
+        bool is_number() const;
+        bool is_int64() const;
+        bool is_uint64() const;
+        bool is_string() const;
+        bool is_array() const;
+        bool is_object() const;
+        bool as_bool() const;
+        double as_number() const;
+        // doubles saturate at the integer range, NaN gives 0
+        int64_t as_int64() const;
+        uint64_t as_uint64() const;
+        std::string_view as_string_view() const;
+        // a missing key or index yields a None value, indexing walks the elements before idx
+        TapeValue operator[](std::string_view k) const;
+        TapeValue operator[](size_t idx) const;
+
+        array_iterator array_begin() const;
+        array_iterator array_end() const;
+        object_iterator object_begin() const;
+        object_iterator object_end() const;
+    };
+
+    class __tape_array_iterator
+    {
+        friend class TapeValue;
+        using self_type = __tape_array_iterator;
+
+        TapeValue cur;
+
+        __tape_array_iterator(const Tape *tape, size_t pos);
+
+    public:
+        __tape_array_iterator();
+
+        const TapeValue &operator*() const;
+        const TapeValue *operator->() const;
+
+        self_type &operator++();
+        self_type operator++(int);
+
+        bool operator==(const self_type &another) const;
+        bool operator!=(const self_type &another) const;
+    };
+
+    class __tape_object_iterator
+    {
+        friend class TapeValue;
+        using self_type = __tape_object_iterator;
+        using member_type = std::pair<std::string_view, TapeValue>;
+
+        const Tape *tape;
+        size_t pos; // the key of the current member
+        member_type cur;
+
+        __tape_object_iterator(const Tape *tape, size_t pos);
+        void load();
+
+    public:
+        __tape_object_iterator();
+
+        const member_type &operator*() const;
+        const member_type *operator->() const;
+
+        self_type &operator++();
+        self_type operator++(int);
+
+        bool operator==(const self_type &another) const;
+        bool operator!=(const self_type &another) const;
+    };
+
+    // a value of an input that has not been parsed yet, the input has to outlive it.
+    // lookups scan over the values before the one asked for without building them, and
+    // report the first syntax error on the way. the rest of the input is never looked at.
+    class LazyValue
+    {
+        friend class __lazy_array_iterator;
+        friend std::pair<ParseStatus, LazyValue> parse_lazy(std::string_view input, const ParseOptions &opts);
+
+        const char *begin; // first byte of the value, nullptr for None
+        const char *end;   // end of the whole input
+        ParseOptions opts;
+
+        LazyValue(const char *begin, const char *end, const ParseOptions &opts);
+
+    public:
+        using array_iterator = __lazy_array_iterator;
+
+        LazyValue();
+
+        // judged by the first byte only
+        ValueType get_type() const;
+        // a missing key or index yields OK and a None value
+        std::pair<ParseStatus, LazyValue> find(std::string_view k) const;
+        std::pair<ParseStatus, LazyValue> at(size_t idx) const;
+        // parses this value, and only this one, into a tree
+        std::pair<ParseStatus, json> get() const;
+
+        array_iterator array_begin() const;
+        array_iterator array_end() const;
+    };
+
+    class __lazy_array_iterator
+    {
+        friend class LazyValue;
+        using self_type = __lazy_array_iterator;
+
+        LazyValue cur; // None once past the last element or an error
+        ParseStatus error;
+
+        explicit __lazy_array_iterator(const LazyValue &first);
+
+    public:
+        __lazy_array_iterator();
+
+        const LazyValue &operator*() const;
+        const LazyValue *operator->() const;
+        // scans over the current element
+        self_type &operator++();
+        // why the iteration stopped, OK at the closing bracket
+        ParseStatus status() const;
+
+        bool operator==(const self_type &another) const;
+        bool operator!=(const self_type &another) const;
+    };
+
+    // assembles a Value from parse events
+    class __dom_builder final : public SaxHandler
+    {
+        friend class StreamParser;
+
+        std::vector<Value> open;       // containers still being filled, innermost last
+        std::vector<std::string> keys; // key of the member each open object is waiting for
+        Value root;
+
+        bool attach(Value &&v);
+        void reset();
+
+    public:
+        bool null() override;
+        bool boolean(bool v) override;
+        bool number(double v) override;
+        bool int64(int64_t v) override;
+        bool uint64(uint64_t v) override;
+        bool string(std::string_view v) override;
+        bool key(std::string_view k) override;
+        bool start_object() override;
+        bool end_object() override;
+        bool start_array() override;
+        bool end_array() override;
+    };
+
+    // push parser for input that arrives in pieces, e.g. from a socket. a chunk may end
+    // anywhere, also inside a string, an escape or a number. only the bytes of a token cut
+    // by a chunk end are kept between calls, the caller can drop each chunk after feed().
+    // errors are the same as for parse() of the concatenated input.
+    class StreamParser
+    {
+        // what the next significant byte has to be, or which token a chunk end cut
+        enum class Expect : unsigned char
+        {
+            Value,        // the root, after ':' and after ',' in an array
+            FirstElement, // after '['
+            FirstKey,     // after '{'
+            Key,          // after ',' in an object
+            Colon,
+            Next, // ',' or the end of the innermost container
+            Done, // the root value is complete
+            String,
+            KeyString,
+            Token // a number or literal
+        };
+
+        SaxHandler *handler;
+        __dom_builder dom;
+        __parser *ps;                 // decodes single tokens
+        std::vector<char> open;       // '[' or '{' of each open container
+        std::string pending;          // the unfinished token
+        Expect expect;
+        bool escaped; // the pending string ends with a lone backslash
+        ParseStatus status;
+
+        ParseStatus fail(ParseStatus s);
+        ParseStatus after_value();
+        ParseStatus emit_value(const char *p, size_t n);
+        ParseStatus emit_key(const char *p, size_t n);
+        ParseStatus close(char c);
+
+    public:
+        // builds a Value, read it with root() once finish() returned OK.
+        // only max_depth is taken from the options, tokens are always decoded from copies.
+        explicit StreamParser(const ParseOptions &opts = ParseOptions());
+        // reports events to the handler instead, it has to outlive the parser
+        explicit StreamParser(SaxHandler &handler, const ParseOptions &opts = ParseOptions());
+        StreamParser(const StreamParser &) = delete;
+        StreamParser &operator=(const StreamParser &) = delete;
+        ~StreamParser();
+
+        // the first error sticks, later calls return it again
+        ParseStatus feed(const char *data, size_t len);
+        ParseStatus feed(std::string_view chunk);
+        // the input is complete, checks that it held exactly one value
+        ParseStatus finish();
+        // starts over for the next document, keeps the buffers
+        void reset();
+
+        Value &root();
+        // bytes held back for the unfinished token
+        size_t buffered() const;
+    };
+
+    // one level of a compiled path
+    struct __query_step
+    {
+        std::string key;
+        size_t index; // SIZE_MAX when the step can not select an array element
+        bool any;     // '*', every member or element
+        bool array_only;
+    };
+
+    struct QueryMatch
+    {
+        size_t path; // index of the path in the Query
+        json value;
+    };
+
+    // a set of paths compiled once and evaluated while the input is scanned. only the matched
+    // values are built, everything no path leads into is skipped. const after compiling, so
+    // one Query can be run from several threads at once.
+    class Query
+    {
+        friend class __parser;
+
+        std::vector<std::vector<__query_step>> paths;
+
+        static ParseStatus compile_pointer(std::string_view path, std::vector<__query_step> &steps);
+        static ParseStatus compile_jsonpath(std::string_view path, std::vector<__query_step> &steps);
+
+    public:
+        // JSON Pointer ("/items/0/price") or simple JSONPath ("$.items[0].price", "$['a b']"),
+        // both with '*' for every member or element. a malformed path gives INVALID_PATH.
+        ParseStatus add(std::string_view path);
+        size_t size() const;
+
+        // matches of all paths in document order. of duplicate keys only the first one matches,
+        // like in a Value. an error gives no matches.
+        std::pair<ParseStatus, std::vector<QueryMatch>> run(std::string_view input, const ParseOptions &opts = ParseOptions()) const;
+    };
+
+    // one shared copy of each distinct string, for keys and values that repeat across documents.
+    // equal strings get the same pointer, so interned keys compare by address. strings are only
+    // freed by clear(), while anything parsed with the pool is still in use they must stay.
+    // lookups are locked, one pool can serve several parsing threads.
+    class StringPool
+    {
+        friend class __parser;
+
+        std::pmr::monotonic_buffer_resource storage;
+        std::vector<std::string_view> slots; // open addressing, a null data pointer is empty
+        size_t count, total;
+        size_t max_value;
+        mutable std::mutex lock;
+
+        void grow();
+
+    public:
+        // string values longer than max_value bytes are copied as usual
+        explicit StringPool(size_t max_value = INTERN_MAX_VALUE);
+        StringPool(const StringPool &) = delete;
+        StringPool &operator=(const StringPool &) = delete;
+
+        // the pooled copy of s, added on first use
+        std::string_view intern(std::string_view s);
+        // distinct strings and their total length
+        size_t size() const;
+        size_t bytes() const;
+        // drops every string, nothing parsed with the pool may be used afterwards
+        void clear();
+    };
+
+    struct ParserStats
+    {
+        size_t documents = 0;
+        // scratch memory held right now, the decoding stack, the structural index and the
+        // containers a tree parse had open at once
+        size_t stack_bytes = 0;
+        size_t index_bytes = 0;
+        size_t frame_bytes = 0;
+        // the most each has held since construction
+        size_t peak_stack_bytes = 0;
+        size_t peak_index_bytes = 0;
+        size_t peak_frame_bytes = 0;
+        // how often the retain limit released memory
+        size_t shrinks = 0;
+    };
+
+    // parses one document after another with the same scratch memory, so only the first few
+    // pay for growing it. not thread-safe, keep one per thread.
+    class Parser
+    {
+        __parser *ps;
+        size_t retain_limit;
+        ParserStats st;
+
+        __parser &prepare(const char *data, size_t len, const ParseOptions &opts, std::pmr::memory_resource *arena);
+        ParseStatus done(ParseStatus status);
+
+    public:
+        // after a parse that leaves more than retain_limit bytes of scratch memory it is released
+        explicit Parser(size_t retain_limit = PARSER_RETAIN_LIMIT);
+        Parser(const Parser &) = delete;
+        Parser &operator=(const Parser &) = delete;
+        ~Parser();
+
+        std::pair<ParseStatus, json> parse(const char *data, size_t len, const ParseOptions &opts = ParseOptions());
+        std::pair<ParseStatus, json> parse(std::string_view input, const ParseOptions &opts = ParseOptions());
+        ParseStatus parse(std::string_view input, Document &doc, const ParseOptions &opts = ParseOptions());
+        ParseStatus parse(std::string_view input, Tape &tape, const ParseOptions &opts = ParseOptions());
+        ParseStatus parse_sax(std::string_view input, SaxHandler &handler, const ParseOptions &opts = ParseOptions());
+
+        const ParserStats &stats() const;
+        void set_retain_limit(size_t bytes);
+        // releases the scratch memory now
+        void shrink();
+    };
+
     struct __char_stack
     {
         __char_stack();
@@ -230,33 +954,133 @@ namespace kkjson
         void *pop(size_t size);
         size_t get_top();
         void set_top(size_t n);
+        size_t get_capacity() const;
+        // frees the memory, the stack has to be empty
+        void shrink();
 
     private:
         size_t capability, top;
         char *ptr;
     };
 
+    // a container the tree parse has opened and not closed yet
+    struct __parse_frame
+    {
+        Value container;
+        // key of the member being parsed, nullptr when it was decoded onto cstack
+        const char *key;
+        size_t key_size;
+    };
+
     class __parser
     {
-        friend std::pair<ParseStatus, json> parse(const char *str);
+        friend std::pair<ParseStatus, json> parse(const char *data, size_t len, const ParseOptions &opts);
+        friend std::pair<ParseStatus, LazyValue> parse_lazy(std::string_view input, const ParseOptions &opts);
+        friend ParseStatus parse_sax(std::string_view input, SaxHandler &handler, const ParseOptions &opts);
+        friend std::pair<ParseStatus, size_t> validate(std::string_view input, const ParseOptions &opts);
+        friend class Document;
+        friend class LazyValue;
+        friend class __lazy_array_iterator;
+        friend class StreamParser;
+        friend class __ndjson_worker;
+        friend class Parser;
+        friend class Query;
 
         __char_stack cstack;
+        const char *raw_begin;
         const char *raw_iter;
+        const char *raw_end;
+        ParseOptions opts;
+        std::pmr::memory_resource *arena;
+        // offsets of structural characters and value starts, filled by build_index
+        std::vector<uint32_t> index;
+        const uint32_t *index_iter;
+        const uint32_t *index_end;
+        // containers open in the tree parse, and in the engines that recurse
+        std::vector<__parse_frame> frames;
+        unsigned nesting;
 
-        __parser(const char *cstr);
+        __parser(const char *data, size_t len, const ParseOptions &opts, std::pmr::memory_resource *arena = nullptr);
         __parser(const __parser &) = delete;
         ~__parser() = default;
 
         ParseStatus exec(Value &out);
+        ParseStatus exec_serial(Value &out);
+        ParseStatus exec_indexed(Value &out);
         ParseStatus parse_whitespace();
         ParseStatus parse_value(Value &out);
         ParseStatus parse_literal(Value &out, const char *target, ValueType t);
         ParseStatus parse_bool(Value &out, const char *target, bool v);
         ParseStatus parse_string(Value &out);
-        ParseStatus parse_string_raw(size_t &length_out);
-        ParseStatus parse_array(Value &out);
-        ParseStatus parse_object(Value &out);
+        ParseStatus parse_string_raw(const char *&in_place, size_t &length_out);
+        ParseStatus parse_scalar(Value &out);
+        ParseStatus parse_key();
+        // runs a recursive scan of a container one level deeper, unless that is past max_depth
+        template <class F>
+        ParseStatus nested(F &&scan);
         ParseStatus parse_number(Value &out);
+
+        // stage 1 and 2 of the structural_index engine
+        bool build_index();
+        char peek_index() const;
+        bool at_index_boundary() const;
+        ParseStatus walk_value(Value &out, ParseStatus junk);
+        ParseStatus walk_array(Value &out);
+        ParseStatus walk_object(Value &out);
+
+        // parses the parts of a top-level array on several threads
+        ParseStatus exec_parallel(Value &out);
+        ParseStatus parse_elements(std::vector<Value> &out);
+
+        // checks the grammar of a value and moves past it without building anything.
+        // on an error raw_iter is left where it was found.
+        ParseStatus skip_value();
+        ParseStatus skip_array();
+        ParseStatus skip_object();
+        ParseStatus skip_string();
+        ParseStatus skip_number();
+        // leave raw_iter at the start of the member or element, or nullptr when there is none
+        ParseStatus lazy_find(std::string_view k, const char *&found);
+        ParseStatus lazy_at(size_t idx, const char *&found);
+        ParseStatus lazy_next(const char *&found);
+
+        // runs every path of the query from the root
+        ParseStatus exec(const Query &q, std::vector<QueryMatch> &out);
+        // evaluates the paths active[first..] at the current value, depth steps deep
+        ParseStatus query_value(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first, std::vector<QueryMatch> &out);
+        ParseStatus query_array(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first, std::vector<QueryMatch> &out);
+        ParseStatus query_object(const Query &q, size_t depth, std::vector<uint32_t> &active, size_t first, std::vector<QueryMatch> &out);
+
+        // reports values to a handler instead of building them
+        ParseStatus exec(SaxHandler &h);
+        ParseStatus sax_value(SaxHandler &h);
+        ParseStatus sax_array(SaxHandler &h);
+        ParseStatus sax_object(SaxHandler &h);
+    };
+
+    class __writer
+    {
+        friend class Value;
+
+        std::string *str; // grown on demand, nullptr when the output was measured up front
+        char *cur, *end;
+        DumpOptions opts;
+
+        __writer(std::string *str, char *buf, size_t cap, const DumpOptions &opts);
+        __writer(const __writer &) = delete;
+        ~__writer() = default;
+
+        char *reserve(size_t n);
+        void put(char c);
+        void write_raw(const char *p, size_t n);
+        void finish();
+
+        static size_t measure_value(const Value &v, unsigned depth, const DumpOptions &opts);
+        static size_t measure_string(std::string_view s);
+        static size_t format_number(const Value &v, char *buf);
+        void write_value(const Value &v, unsigned depth);
+        void write_string(std::string_view s);
+        void write_newline(unsigned depth);
     };
 }
 
@@ -3,8 +3,13 @@
 #define COLUMN_1_WIDTH 35
 #define COLUMN_2_WIDTH 35
 
+#include <atomic>
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
 #include "kkjson.h"
 using kkjson::parse, kkjson::ParseStatus,
     kkjson::ValueType, kkjson::json;
@@ -14,6 +19,8 @@ using std::ostream;
 
 namespace
 {
+    // the grammar cases run once per parse engine
+    kkjson::ParseOptions engine_opts;
     unsigned int test_count = 0;
     unsigned int test_pass = 0;
     bool exist_err = false;
@@ -66,6 +73,14 @@ std::ostream &operator<<(std::ostream &o, ParseStatus ps)
         // object
         ENUM_OUTPUT_CASE_STATUS(MISS_OBJECT_KEY);
         ENUM_OUTPUT_CASE_STATUS(MISS_OBJECT_SYMBOL);
+        // sax
+        ENUM_OUTPUT_CASE_STATUS(ABORTED);
+        // file
+        ENUM_OUTPUT_CASE_STATUS(FILE_UNREADABLE);
+        // query
+        ENUM_OUTPUT_CASE_STATUS(INVALID_PATH);
+        // nesting
+        ENUM_OUTPUT_CASE_STATUS(DEPTH_EXCEEDED);
     default:
         o << "STATUS(UNKNOWN)";
         break;
@@ -136,65 +151,65 @@ std::ostream &operator<<(std::ostream &o, ValueType vt)
     "[...]", "[...]")
 #endif
 
-#define TEST_LITERAL(_vtype, _str)         \
-    do                                     \
-    {                                      \
-        auto [_ps, _j] = parse(_str);      \
-        EXPECT_INT(ParseStatus::OK, _ps);  \
-        EXPECT_INT(_vtype, _j.get_type()); \
+#define TEST_LITERAL(_vtype, _str)                                   \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(_vtype, _j.get_type());                           \
     } while (0)
 
-#define TEST_BOOL(_value, _str)                     \
-    do                                              \
-    {                                               \
-        auto [_ps, _j] = parse(_str);               \
-        EXPECT_INT(ParseStatus::OK, _ps);           \
-        EXPECT_INT(ValueType::Bool, _j.get_type()); \
-        EXPECT_BOOL(_value, _j.as_bool());          \
+#define TEST_BOOL(_value, _str)                                      \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(ValueType::Bool, _j.get_type());                  \
+        EXPECT_BOOL(_value, _j.as_bool());                           \
     } while (0)
 
-#define TEST_NUMBER(_value, _str)                     \
-    do                                                \
-    {                                                 \
-        auto [_ps, _j] = parse(_str);                 \
-        EXPECT_INT(ParseStatus::OK, _ps);             \
-        EXPECT_INT(ValueType::Number, _j.get_type()); \
-        EXPECT_DOUBLE(_value, _j.as_number());        \
+#define TEST_NUMBER(_value, _str)                                    \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(ValueType::Number, _j.get_type());                \
+        EXPECT_DOUBLE(_value, _j.as_number());                       \
     } while (0)
 
-#define TEST_STRING(_value, _str)                     \
-    do                                                \
-    {                                                 \
-        auto [_ps, _j] = parse(_str);                 \
-        EXPECT_INT(ParseStatus::OK, _ps);             \
-        EXPECT_INT(ValueType::String, _j.get_type()); \
-        EXPECT_STRING(_value, _j.as_string());        \
+#define TEST_STRING(_value, _str)                                    \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(ValueType::String, _j.get_type());                \
+        EXPECT_STRING(_value, _j.as_string());                       \
     } while (0)
 
-#define TEST_ARRAY_STAT(_value_count, _str)          \
-    do                                               \
-    {                                                \
-        auto [_ps, _j] = parse(_str);                \
-        EXPECT_INT(ParseStatus::OK, _ps);            \
-        EXPECT_INT(ValueType::Array, _j.get_type()); \
-        EXPECT_SIZE_T(_value_count, _j.get_size());  \
-        tmp = std::move(_j);                         \
+#define TEST_ARRAY_STAT(_value_count, _str)                          \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(ValueType::Array, _j.get_type());                 \
+        EXPECT_SIZE_T(_value_count, _j.get_size());                  \
+        tmp = std::move(_j);                                         \
     } while (0)
 
-#define TEST_OBJECT_STAT(_str)                        \
-    do                                                \
-    {                                                 \
-        auto [_ps, _j] = parse(_str);                 \
-        EXPECT_INT(ParseStatus::OK, _ps);             \
-        EXPECT_INT(ValueType::Object, _j.get_type()); \
-        tmp = std::move(_j);                          \
+#define TEST_OBJECT_STAT(_str)                                       \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(ParseStatus::OK, _ps);                            \
+        EXPECT_INT(ValueType::Object, _j.get_type());                \
+        tmp = std::move(_j);                                         \
     } while (0)
 
-#define TEST_ERROR(_status, _str)     \
-    do                                \
-    {                                 \
-        auto [_ps, _j] = parse(_str); \
-        EXPECT_INT(_status, _ps);     \
+#define TEST_ERROR(_status, _str)                                    \
+    do                                                               \
+    {                                                                \
+        auto [_ps, _j] = parse(std::string_view(_str), engine_opts); \
+        EXPECT_INT(_status, _ps);                                    \
     } while (0)
 
 namespace
@@ -241,6 +256,92 @@ namespace
         TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
     }
 
+    void test_parse_number_rounding()
+    {
+        // past the exact double fast path
+        TEST_NUMBER(1e23, "1e23");
+        TEST_NUMBER(9007199254740992.0, "9007199254740993");
+        TEST_NUMBER(9007199254740994.0, "9007199254740993.0000000000000000001");
+        TEST_NUMBER(7.2057594037927933e16, "72057594037927933");
+        TEST_NUMBER(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+        TEST_NUMBER(1e-5, "0.00001");
+        TEST_NUMBER(123.456, "0.000000000000000000000000000000000000000123456e42");
+        TEST_NUMBER(1e20, "100000000000000000000000000000000000000000e-21");
+        // subnormal boundaries and the halfway points around them
+        TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+        TEST_NUMBER(2.2250738585072014e-308, "2.2250738585072012e-308");
+        TEST_NUMBER(0.0, "2.4703282292062327e-324");
+        TEST_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324");
+        TEST_NUMBER(1.7976931348623157e+308, "1.7976931348623158e+308");
+        TEST_NUMBER(0.0, "0e999999999999");
+        // a number ending exactly at the end of a bounded input
+        auto [st, js] = parse("3.25e2xxxx", 6);
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_DOUBLE(325.0, js.as_number());
+    }
+
+    void test_parse_integer()
+    {
+        auto [st, js] = parse("[0, -1, 42, 9007199254740993, -9223372036854775808, 9223372036854775807, "
+                              "9223372036854775808, 18446744073709551615, 18446744073709551616, -9223372036854775809, "
+                              "-0, 1.0, 1e2]");
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_BOOL(true, js[0].is_int64());
+        EXPECT_INT(0, js[0].as_int64());
+        EXPECT_BOOL(true, js[1].is_int64());
+        EXPECT_BOOL(false, js[1].is_uint64());
+        EXPECT_INT(-1, js[1].as_int64());
+        EXPECT_DOUBLE(42.0, js[2].as_number());
+        // exact beyond 2^53
+        EXPECT_BOOL(true, js[3].as_int64() == 9007199254740993LL);
+        EXPECT_BOOL(true, js[4].as_int64() == INT64_MIN);
+        EXPECT_BOOL(true, js[5].as_int64() == INT64_MAX);
+        EXPECT_BOOL(false, js[6].is_int64());
+        EXPECT_BOOL(true, js[6].is_uint64());
+        EXPECT_BOOL(true, js[6].as_uint64() == 9223372036854775808ULL);
+        EXPECT_BOOL(true, js[7].as_uint64() == UINT64_MAX);
+        EXPECT_DOUBLE(18446744073709551615.0, js[7].as_number());
+        // out of range integers and anything with a fraction or exponent are doubles
+        EXPECT_BOOL(false, js[8].is_uint64());
+        EXPECT_DOUBLE(18446744073709551616.0, js[8].as_number());
+        EXPECT_BOOL(false, js[9].is_int64());
+        EXPECT_DOUBLE(-9223372036854775809.0, js[9].as_number());
+        EXPECT_BOOL(false, js[10].is_int64());
+        EXPECT_BOOL(true, std::signbit(js[10].as_number()));
+        EXPECT_BOOL(false, js[11].is_int64());
+        EXPECT_INT(1, js[11].as_int64());
+        EXPECT_BOOL(false, js[12].is_int64());
+        EXPECT_INT(100, js[12].as_uint64());
+
+        // reading as_number() keeps the integer, writing a double replaces it
+        json copy = js[3];
+        EXPECT_DOUBLE(9007199254740992.0, copy.as_number());
+        EXPECT_BOOL(true, copy.is_int64() && copy.as_int64() == 9007199254740993LL);
+        copy.set_number(copy.as_number() + 0.5);
+        EXPECT_BOOL(false, copy.is_int64());
+        EXPECT_DOUBLE(9007199254740992.0, copy.as_number());
+        copy = int64_t(-7);
+        EXPECT_INT(-7, copy.as_int64());
+        copy = UINT64_MAX;
+        EXPECT_BOOL(true, copy.as_uint64() == UINT64_MAX);
+
+        kkjson::Document doc;
+        EXPECT_INT(ParseStatus::OK, doc.parse("{\"id\": 12345678901234567890}"));
+        EXPECT_BOOL(true, doc.root()["id"].as_uint64() == 12345678901234567890ULL);
+
+        // integer reads saturate at the target range, NaN gives 0
+        auto [st2, big] = parse("[1e300, -1e300, -1.5, 2.5, -1, 18446744073709551615]");
+        EXPECT_INT(ParseStatus::OK, st2);
+        EXPECT_BOOL(true, big[0].as_int64() == INT64_MAX && big[0].as_uint64() == UINT64_MAX);
+        EXPECT_BOOL(true, big[1].as_int64() == INT64_MIN && big[1].as_uint64() == 0);
+        EXPECT_BOOL(true, big[2].as_int64() == -1 && big[2].as_uint64() == 0);
+        EXPECT_BOOL(true, big[3].as_int64() == 2 && big[3].as_uint64() == 2);
+        EXPECT_BOOL(true, big[4].as_uint64() == 0);
+        EXPECT_BOOL(true, big[5].as_int64() == INT64_MAX);
+        json nan = std::nan("");
+        EXPECT_BOOL(true, nan.as_int64() == 0 && nan.as_uint64() == 0);
+    }
+
     void test_parse_string()
     {
         TEST_STRING("", "\"\"");
@@ -367,6 +468,8 @@ namespace
         TEST_ERROR(ParseStatus::NUMBER_TOO_LARGE, "1e999");
         TEST_ERROR(ParseStatus::NUMBER_TOO_LARGE, "-1e309");
         TEST_ERROR(ParseStatus::NUMBER_TOO_LARGE, "-1e9999");
+        TEST_ERROR(ParseStatus::NUMBER_TOO_LARGE, "1.7976931348623159e308");
+        TEST_ERROR(ParseStatus::NUMBER_TOO_LARGE, "1000000000000000000000e300");
     }
 
     void test_error_miss_quotation_mark()
@@ -446,6 +549,1102 @@ namespace
         TEST_ERROR(ParseStatus::MISS_OBJECT_SYMBOL, "{\"a\":{}");
     }
 
+    void test_parse_bounded()
+    {
+        // only the first len bytes belong to the document
+        const char buf[] = "[1, 2]3] \"abc\"def";
+        {
+            auto [st, js] = parse(buf, 6);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_SIZE_T(2, js.get_size());
+        }
+        {
+            auto [st, js] = parse(buf, 5);
+            EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, st);
+        }
+        {
+            auto [st, js] = parse(std::string_view(buf + 9, 5));
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_STRING("abc", js.as_string());
+        }
+        {
+            auto [st, js] = parse(std::string_view(buf + 9, 4));
+            EXPECT_INT(ParseStatus::MISS_QUOTATION_MARK, st);
+        }
+        {
+            auto [st, js] = parse(std::string_view("1.5e3", 3));
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_DOUBLE(1.5, js.as_number());
+        }
+        {
+            auto [st, js] = parse(std::string_view("tru", 3));
+            EXPECT_INT(ParseStatus::INVALID_VALUE, st);
+        }
+        {
+            auto [st, js] = parse(std::string_view("\"\\u00", 5));
+            EXPECT_INT(ParseStatus::INVALID_UNICODE_HEX, st);
+        }
+        // an embedded zero is an ordinary byte now
+        {
+            auto [st, js] = parse(std::string_view("\"a\0b\"", 5));
+            EXPECT_INT(ParseStatus::INVALID_STRING_CHAR, st);
+        }
+        {
+            auto [st, js] = parse(std::string_view("null\0", 5));
+            EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, st);
+        }
+        // padded input, the bytes after the end must not be consumed
+        {
+            std::string padded = "{\"k\": [true, \"v\"]}";
+            size_t len = padded.size();
+            padded.append(kkjson::PARSE_PADDING, ' ');
+            padded.replace(len, 4, "1]}\"");
+            kkjson::ParseOptions opts;
+            opts.padded = true;
+            auto [st, js] = parse(padded.data(), len, opts);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_SIZE_T(2, js["k"].get_size());
+        }
+    }
+
+    void test_parse_whitespace()
+    {
+        // runs around the block widths of the vectorized skip
+        for (size_t n = 0; n < 80; n++)
+        {
+            std::string ws;
+            for (size_t i = 0; i < n; i++)
+                ws += " \t\n\r"[i % 4];
+            std::string doc = ws + "[" + ws + "1" + ws + "," + ws + "{" + ws + "}" + ws + "]" + ws;
+            auto [st, js] = parse(doc);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_SIZE_T(2, js.get_size());
+
+            // whitespace that runs past the end of the range, then garbage
+            std::string tail = "[]" + ws + "x";
+            auto [st2, js2] = parse(tail.data(), tail.size() - 1);
+            EXPECT_INT(ParseStatus::OK, st2);
+            auto [st3, js3] = parse(tail);
+            EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, st3);
+
+            kkjson::ParseOptions opts;
+            opts.padded = true;
+            std::string padded = "[" + ws + "]" + ws;
+            size_t len = padded.size();
+            padded.append(kkjson::PARSE_PADDING, ' ');
+            auto [st4, js4] = parse(padded.data(), len, opts);
+            EXPECT_INT(ParseStatus::OK, st4);
+            padded[len] = '1';
+            auto [st5, js5] = parse(padded.data(), len + 1, opts);
+            EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, st5);
+        }
+    }
+
+    void test_parse_long_string()
+    {
+        // clean runs of every length around the block widths of the vectorized scan
+        for (size_t n = 0; n < 100; n++)
+        {
+            std::string run(n, 'a');
+            for (size_t i = 0; i < n; i++)
+                run[i] += i % 26;
+            {
+                auto [st, js] = parse("\"" + run + "\\n" + run + "\"");
+                EXPECT_INT(ParseStatus::OK, st);
+                EXPECT_BOOL(true, js.as_string() == run + "\n" + run);
+            }
+            {
+                auto [st, js] = parse("\"" + run + "\x01" + run + "\"");
+                EXPECT_INT(ParseStatus::INVALID_STRING_CHAR, st);
+            }
+            {
+                auto [st, js] = parse("\"" + run);
+                EXPECT_INT(ParseStatus::MISS_QUOTATION_MARK, st);
+            }
+            {
+                std::string doc = "\"" + run + "\"";
+                auto [st, js] = parse(doc.data(), doc.size() - 1);
+                EXPECT_INT(ParseStatus::MISS_QUOTATION_MARK, st);
+            }
+            {
+                kkjson::ParseOptions opts;
+                opts.padded = true;
+                std::string doc = "\"" + run;
+                size_t len = doc.size();
+                doc.append(kkjson::PARSE_PADDING, '"');
+                auto [st, js] = parse(doc.data(), len, opts);
+                EXPECT_INT(ParseStatus::MISS_QUOTATION_MARK, st);
+            }
+        }
+    }
+
+    void test_parse_borrowed()
+    {
+        const std::string doc = "[\"plain\", \"esc\\naped\", {\"key\": \"value\"}, \"\"]";
+        kkjson::ParseOptions opts;
+        opts.borrow_strings = true;
+        auto [st, js] = parse(doc, opts);
+        EXPECT_INT(ParseStatus::OK, st);
+        auto inside = [&doc](std::string_view v)
+        { return v.data() >= doc.data() && v.data() < doc.data() + doc.size(); };
+
+        EXPECT_INT(ValueType::String, js[0].get_type());
+        EXPECT_BOOL(true, inside(js[0].as_string_view()));
+        EXPECT_STRING("plain", js[0].as_string_view());
+        EXPECT_SIZE_T(5, js[0].get_size());
+        EXPECT_BOOL(false, inside(js[1].as_string_view()));
+        EXPECT_STRING("esc\naped", js[1].as_string_view());
+        EXPECT_BOOL(true, inside(js[2]["key"].as_string_view()));
+        EXPECT_STRING("value", js[2]["key"].as_string_view());
+        EXPECT_SIZE_T(0, js[3].get_size());
+
+        // copies keep borrowing, as_string() detaches
+        json copy = js[0];
+        EXPECT_BOOL(true, inside(copy.as_string_view()));
+        EXPECT_STRING("plain", copy.as_string());
+        EXPECT_BOOL(false, inside(copy.as_string_view()));
+        copy.as_string() += "!";
+        EXPECT_STRING("plain!", copy.as_string_view());
+        EXPECT_STRING("plain", js[0].as_string_view());
+
+        json moved = std::move(js[0]);
+        EXPECT_BOOL(true, inside(moved.as_string_view()));
+        EXPECT_INT(ValueType::None, js[0].get_type());
+
+        // the default still copies
+        auto [st2, js2] = parse(doc);
+        EXPECT_BOOL(false, inside(js2[0].as_string_view()));
+        EXPECT_STRING("plain", js2[0].as_string_view());
+    }
+
+    void test_document()
+    {
+        kkjson::Document doc(256);
+        ParseStatus st = doc.parse("{\"list\": [1, \"two\", [true, null]], \"a rather long key name\": "
+                                   "\"a string long enough to leave the small string buffer\", \"e\": \"\\u00A2\"}");
+        EXPECT_INT(ParseStatus::OK, st);
+        const json &root = doc.root();
+        EXPECT_INT(ValueType::Object, root.get_type());
+        EXPECT_SIZE_T(3, root.get_size());
+        EXPECT_SIZE_T(3, root["list"].get_size());
+        EXPECT_DOUBLE(1, root["list"][0].as_number());
+        EXPECT_STRING("two", root["list"][1].as_string_view());
+        EXPECT_BOOL(true, root["list"][2][0].as_bool());
+        EXPECT_INT(ValueType::Null, root["list"][2][1].get_type());
+        EXPECT_STRING("a string long enough to leave the small string buffer",
+                      root["a rather long key name"].as_string_view());
+        EXPECT_STRING("\xC2\xA2", root["e"].as_string_view());
+        EXPECT_INT(ValueType::None, root["missing"].get_type());
+
+        // copies out of the document own their memory
+        json copy = root;
+        EXPECT_INT(ParseStatus::OK, doc.parse("[\"x\"]"));
+        EXPECT_SIZE_T(1, doc.root().get_size());
+        EXPECT_STRING("x", doc.root()[0].as_string_view());
+        EXPECT_STRING("two", copy["list"][1].as_string());
+        EXPECT_STRING("a string long enough to leave the small string buffer",
+                      copy["a rather long key name"].as_string_view());
+
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, doc.parse("[1, 2"));
+        EXPECT_INT(ValueType::None, doc.root().get_type());
+
+        std::string input = "{\"k\": \"borrowed\"}";
+        kkjson::ParseOptions opts;
+        opts.borrow_strings = true;
+        EXPECT_INT(ParseStatus::OK, doc.parse(input, opts));
+        EXPECT_BOOL(true, doc.root()["k"].as_string_view().data() == input.data() + 7);
+
+        doc.reset();
+        EXPECT_INT(ValueType::None, doc.root().get_type());
+    }
+
+    void test_object_storage()
+    {
+        // small and indexed objects, insertion order, first duplicate wins
+        for (size_t n : {3, 16, 17, 40, 1000})
+        {
+            std::string doc = "{";
+            for (size_t i = 0; i < n; i++)
+                doc += "\"k" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+            doc += "\"k0\": -1, \"\": \"empty\"}";
+            auto [st, js] = parse(doc);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_SIZE_T(n + 1, js.get_size());
+            bool found = true, ordered = true;
+            for (size_t i = 0; i < n; i++)
+                found = found && js["k" + std::to_string(i)].as_number() == double(i);
+            size_t i = 0;
+            for (auto it = js.object_begin(); it != js.object_end() && i < n; ++it, ++i)
+                ordered = ordered && it->first == "k" + std::to_string(i);
+            EXPECT_BOOL(true, found);
+            EXPECT_BOOL(true, ordered);
+            EXPECT_STRING("empty", js[""].as_string());
+
+            const json copy = js;
+            EXPECT_SIZE_T(n + 1, copy.get_size());
+            EXPECT_DOUBLE(double(n - 1), copy["k" + std::to_string(n - 1)].as_number());
+            EXPECT_INT(ValueType::None, copy["nope"].get_type());
+
+            // inserting through operator[] keeps the index up to date
+            for (size_t j = 0; j < n; j++)
+                js["x" + std::to_string(j)] = double(j);
+            EXPECT_SIZE_T(2 * n + 1, js.get_size());
+            EXPECT_DOUBLE(double(n - 1), js["x" + std::to_string(n - 1)].as_number());
+            EXPECT_DOUBLE(0, js["k0"].as_number());
+        }
+
+        kkjson::Document doc;
+        doc.parse("{\"b\": 1, \"a\": [true, false]}");
+        const json &root = doc.root();
+        json::const_object_iterator oit = root.object_begin();
+        EXPECT_STRING("b", oit->first);
+        ++oit;
+        EXPECT_STRING("a", oit->first);
+        json::const_array_iterator ait = oit->second.array_begin();
+        EXPECT_BOOL(true, ait->as_bool());
+        EXPECT_BOOL(false, ait[1].as_bool());
+        EXPECT_INT(2, oit->second.array_end() - ait);
+        EXPECT_BOOL(true, ++oit == root.object_end());
+    }
+
+    void test_dump()
+    {
+        const char doc[] = "{\"a\":[1,-2,0.1,1e+300,18446744073709551615,true,false,null],\"b\":{},\"c\":[],"
+                          "\"s\":\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f/\xC2\xA2\"}";
+        auto [st, js] = parse(doc);
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_STRING(doc, js.dump());
+        EXPECT_SIZE_T(std::strlen(doc), js.dump_size());
+
+        kkjson::DumpOptions pretty;
+        pretty.indent = 2;
+        auto [st2, js2] = parse("{\"k\": [1, {\"x\": \"y\"}], \"e\": []}");
+        EXPECT_INT(ParseStatus::OK, st2);
+        const char expect[] = "{\n  \"k\": [\n    1,\n    {\n      \"x\": \"y\"\n    }\n  ],\n  \"e\": []\n}";
+        EXPECT_STRING(expect, js2.dump(pretty));
+        EXPECT_SIZE_T(std::strlen(expect), js2.dump_size(pretty));
+        pretty.exact_size = true;
+        EXPECT_STRING(expect, js2.dump(pretty));
+
+        // shortest round trip
+        auto [st3, js3] = parse("[0.30000000000000004, 5e-324, -0.0, 123456.789]");
+        EXPECT_STRING("[0.30000000000000004,5e-324,-0,123456.789]", js3.dump());
+
+        // long strings go through the bulk path, the output parses back to the same value
+        std::string run(1000, 'x');
+        run[500] = '\n';
+        json long_str = run;
+        auto [st4, js4] = parse(long_str.dump());
+        EXPECT_INT(ParseStatus::OK, st4);
+        EXPECT_BOOL(true, js4.as_string() == run);
+
+        char buf[8];
+        EXPECT_SIZE_T(3, json(2.5).dump(buf, sizeof(buf)));
+        EXPECT_STRING("2.5", std::string(buf, 3));
+        EXPECT_SIZE_T(10, json(std::string("too long")).dump(buf, sizeof(buf)));
+    }
+
+    void test_structural_index()
+    {
+        kkjson::ParseOptions indexed;
+        indexed.structural_index = true;
+        // strings, escape runs and tokens straddling 64-byte blocks
+        for (size_t pad = 0; pad < 70; pad++)
+        {
+            std::string fill(pad, ' ');
+            std::string doc = "{" + fill + "\"k\\\\\": [" + fill + "\"a\\\"b\\\\\", 12.5e1," + fill +
+                              "true, null, {\"\": \"x" + fill + "y\"}, \"\\\\\\\\\\\"\"]}";
+            auto [st, js] = parse(doc, indexed);
+            auto [st2, js2] = parse(doc);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_BOOL(true, js.dump() == js2.dump());
+
+            // junk glued to a token or a value cut short gives the same error either way
+            for (const char *junk : {"x", "\"", "1", ",", "]"})
+            {
+                for (size_t at : {size_t(1), pad + 2, doc.size() / 2, doc.size() - 1})
+                {
+                    std::string bad = doc;
+                    bad.insert(at, junk);
+                    EXPECT_INT(parse(bad).first, parse(bad, indexed).first);
+                    EXPECT_INT(parse(doc.substr(0, at)).first, parse(doc.substr(0, at), indexed).first);
+                }
+            }
+        }
+
+        kkjson::Document doc;
+        EXPECT_INT(ParseStatus::OK, doc.parse("[{\"a\": [1, 2, 3]}, \"s\"]", indexed));
+        EXPECT_DOUBLE(3, doc.root()[0]["a"][2].as_number());
+        EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, doc.parse("[1] [2]", indexed));
+
+        // errors come from the walk itself, junk glued to a scalar by the container it is in
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, parse("[1x]", indexed).first);
+        EXPECT_INT(ParseStatus::MISS_OBJECT_SYMBOL, parse("{\"a\": truex}", indexed).first);
+        EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, parse("nullx", indexed).first);
+        EXPECT_INT(ParseStatus::INVALID_VALUE, parse("[1, ]", indexed).first);
+        EXPECT_INT(ParseStatus::UNEXPECTED_SYMBOL, parse("[1, ", indexed).first);
+        EXPECT_INT(ParseStatus::MISS_QUOTATION_MARK, parse("[\"open", indexed).first);
+    }
+
+    void test_tape()
+    {
+        kkjson::Tape tape;
+        EXPECT_INT(ParseStatus::OK, tape.parse("{\"list\": [1, -2, 2.5, 18446744073709551615, \"two\", [true, null], {}], "
+                                               "\"e\\n\": \"\\u00A2\", \"dup\": 1, \"dup\": 2, \"last\": false}"));
+        kkjson::TapeValue root = tape.root();
+        EXPECT_INT(ValueType::Object, root.get_type());
+        EXPECT_SIZE_T(5, root.get_size());
+        kkjson::TapeValue list = root["list"];
+        EXPECT_INT(ValueType::Array, list.get_type());
+        EXPECT_SIZE_T(7, list.get_size());
+        EXPECT_BOOL(true, list[0].is_int64());
+        EXPECT_INT(-2, list[1].as_int64());
+        EXPECT_DOUBLE(2.5, list[2].as_number());
+        EXPECT_BOOL(true, list[3].as_uint64() == UINT64_MAX);
+        EXPECT_STRING("two", list[4].as_string_view());
+        EXPECT_SIZE_T(3, list[4].get_size());
+        EXPECT_BOOL(true, list[5][0].as_bool());
+        EXPECT_INT(ValueType::Null, list[5][1].get_type());
+        EXPECT_SIZE_T(0, list[6].get_size());
+        EXPECT_INT(ValueType::None, list[7].get_type());
+        EXPECT_STRING("\xC2\xA2", root["e\n"].as_string_view());
+        EXPECT_INT(1, root["dup"].as_int64());
+        // the lookup skips the whole list in one step
+        EXPECT_BOOL(false, root["last"].as_bool());
+        EXPECT_INT(ValueType::None, root["missing"].get_type());
+        EXPECT_INT(ValueType::None, list["k"].get_type());
+
+        size_t i = 0;
+        bool same = true;
+        for (auto it = list.array_begin(); it != list.array_end(); ++it, ++i)
+            same = same && it->get_type() == list[i].get_type();
+        EXPECT_BOOL(true, same);
+        EXPECT_SIZE_T(7, i);
+        auto oit = root.object_begin();
+        EXPECT_STRING("list", oit->first);
+        EXPECT_INT(ValueType::Array, (oit++)->second.get_type());
+        EXPECT_STRING("e\n", (*oit).first);
+        EXPECT_BOOL(true, root["list"][6].object_begin() == root["list"][6].object_end());
+
+        // same errors as a Value parse, the tape is left empty
+        for (const char *bad : {"[1, 2", "{\"a\" 1}", "[\"\\x\"]", "1 2", "", "1e999"})
+        {
+            EXPECT_INT(parse(bad).first, tape.parse(bad));
+            EXPECT_INT(ValueType::None, tape.root().get_type());
+        }
+
+        // element counts past what the start word holds
+        std::string big = "[0";
+        for (int n = 1; n < 70000; n++)
+            big += ",[" + std::to_string(n) + "]";
+        big += "]";
+        EXPECT_INT(ParseStatus::OK, tape.parse(big));
+        EXPECT_SIZE_T(70000, tape.root().get_size());
+        EXPECT_INT(69999, tape.root()[69999][0].as_int64());
+
+        // integers in 48 bits and all doubles share a word with their tag, the others take two
+        EXPECT_INT(ParseStatus::OK, tape.parse("[140737488355327, -140737488355328, 140737488355328, -140737488355329,"
+                                               " -9223372036854775808, 18446744073709551615, -0.0, 1e308, 5e-324, 0]"));
+        kkjson::TapeValue nums = tape.root();
+        EXPECT_BOOL(true, nums[0].as_int64() == 140737488355327);
+        EXPECT_BOOL(true, nums[1].as_int64() == -140737488355328);
+        EXPECT_BOOL(true, nums[2].as_int64() == 140737488355328);
+        EXPECT_BOOL(true, nums[3].as_int64() == -140737488355329);
+        EXPECT_BOOL(true, nums[4].as_int64() == INT64_MIN);
+        EXPECT_BOOL(true, nums[5].as_uint64() == UINT64_MAX);
+        EXPECT_BOOL(true, nums[1].is_int64() && !nums[1].is_uint64() && nums[0].is_uint64());
+        EXPECT_BOOL(true, std::signbit(nums[6].as_number()) && !nums[6].is_int64());
+        EXPECT_DOUBLE(1e308, nums[7].as_number());
+        EXPECT_DOUBLE(5e-324, nums[8].as_number());
+        EXPECT_INT(0, nums[9].as_int64());
+        EXPECT_SIZE_T(10, nums.get_size());
+        // start and end words, six narrow numbers, four wide ones
+        EXPECT_SIZE_T((2 + 6 + 4 * 2) * 8, tape.bytes());
+
+        EXPECT_INT(ParseStatus::OK, tape.parse("[1e300, -1e300, -1.5, -1, -140737488355329, 18446744073709551615]"));
+        nums = tape.root();
+        EXPECT_BOOL(true, nums[0].as_int64() == INT64_MAX && nums[0].as_uint64() == UINT64_MAX);
+        EXPECT_BOOL(true, nums[1].as_int64() == INT64_MIN && nums[1].as_uint64() == 0);
+        EXPECT_BOOL(true, nums[2].as_int64() == -1 && nums[2].as_uint64() == 0);
+        EXPECT_BOOL(true, nums[3].as_uint64() == 0 && nums[4].as_uint64() == 0);
+        EXPECT_BOOL(true, nums[5].as_int64() == INT64_MAX);
+    }
+
+    void test_lazy()
+    {
+        const std::string doc = " {\"skip\": {\"deep\": [1, \"]}\", {\"x\": null}]}, \"k\\u0065y\": [10, \"s\", [2], true],"
+                                " \"key\": 2, \"n\": -1.5e1, \"bad\": [1 2]} ";
+        auto [st, root] = kkjson::parse_lazy(doc);
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_INT(ValueType::Object, root.get_type());
+
+        // escaped keys compare decoded, the first duplicate wins
+        auto [st1, arr] = root.find("key");
+        EXPECT_INT(ParseStatus::OK, st1);
+        EXPECT_INT(ValueType::Array, arr.get_type());
+        auto [st2, elem] = arr.at(2);
+        EXPECT_INT(ParseStatus::OK, st2);
+        auto [st3, js] = elem.get();
+        EXPECT_INT(ParseStatus::OK, st3);
+        EXPECT_DOUBLE(2, js[0].as_number());
+        EXPECT_INT(ValueType::None, arr.at(4).second.get_type());
+        EXPECT_DOUBLE(-15, root.find("n").second.get().second.as_number());
+        EXPECT_INT(ValueType::None, root.find("missing").second.get_type());
+        EXPECT_INT(ValueType::None, root.find("n").second.find("x").second.get_type());
+
+        size_t count = 0;
+        auto it = arr.array_begin();
+        for (; it != arr.array_end(); ++it)
+            count++;
+        EXPECT_SIZE_T(4, count);
+        EXPECT_INT(ParseStatus::OK, it.status());
+        auto [st4, empty] = kkjson::parse_lazy("[ ]");
+        EXPECT_BOOL(true, empty.array_begin() == empty.array_end());
+
+        // errors show up where the scan runs into them, with the DOM parse codes
+        auto [st5, bad] = root.find("bad");
+        EXPECT_INT(ParseStatus::OK, st5);
+        auto bit = bad.array_begin();
+        EXPECT_INT(ParseStatus::OK, bit.status());
+        ++bit;
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, bit.status());
+        EXPECT_BOOL(true, bit == bad.array_end());
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, root.find("zzz").first);
+        EXPECT_INT(ParseStatus::INVALID_STRING_ESCAPE, kkjson::parse_lazy("{\"a\": \"\\x\", \"b\": 1}").second.find("b").first);
+        EXPECT_INT(ParseStatus::MISS_OBJECT_SYMBOL, kkjson::parse_lazy("{\"a\" 1}").second.find("b").first);
+        EXPECT_INT(ParseStatus::UNEXPECTED_SYMBOL, kkjson::parse_lazy("  ").first);
+        EXPECT_INT(ParseStatus::INVALID_VALUE, kkjson::parse_lazy("[tru]").second.at(0).second.get().first);
+    }
+
+    // writes every event as one letter, numbers by how they arrived
+    struct sax_recorder : kkjson::SaxHandler
+    {
+        std::string events;
+        size_t stop_after = SIZE_MAX;
+
+        bool add(char c)
+        {
+            events += c;
+            return events.size() < stop_after;
+        }
+        bool null() override { return add('n'); }
+        bool boolean(bool v) override { return add(v ? 't' : 'f'); }
+        bool number(double) override { return add('d'); }
+        bool int64(int64_t) override { return add('l'); }
+        bool uint64(uint64_t) override { return add('u'); }
+        bool string(std::string_view) override { return add('s'); }
+        bool key(std::string_view) override { return add('k'); }
+        bool start_object() override { return add('{'); }
+        bool end_object() override { return add('}'); }
+        bool start_array() override { return add('['); }
+        bool end_array() override { return add(']'); }
+    };
+
+    // not derived from SaxHandler and without int64/uint64
+    struct sax_summer
+    {
+        double sum = 0;
+        std::string keys;
+
+        bool null() { return true; }
+        bool boolean(bool) { return true; }
+        bool number(double v)
+        {
+            sum += v;
+            return true;
+        }
+        bool string(std::string_view) { return true; }
+        bool key(std::string_view k)
+        {
+            keys += k;
+            return true;
+        }
+        bool start_object() { return true; }
+        bool end_object() { return true; }
+        bool start_array() { return true; }
+        bool end_array() { return true; }
+    };
+
+    void test_sax()
+    {
+        const std::string doc = "{\"a\": [null, true, false, -3, 18446744073709551615, 1.5, \"x\\ny\"], \"b\": {}}";
+        sax_recorder rec;
+        EXPECT_INT(ParseStatus::OK, kkjson::parse_sax(doc, rec));
+        EXPECT_STRING("{k[ntfluds]k{}}", rec.events);
+
+        sax_summer sum;
+        EXPECT_INT(ParseStatus::OK, kkjson::parse_sax(doc, sum));
+        EXPECT_DOUBLE(-3 + 18446744073709551615.0 + 1.5, sum.sum);
+        EXPECT_STRING("ab", sum.keys);
+
+        sax_recorder stop;
+        stop.stop_after = 3;
+        EXPECT_INT(ParseStatus::ABORTED, kkjson::parse_sax(doc, stop));
+        EXPECT_STRING("{k[", stop.events);
+
+        // same codes as parse(), events before the error have been delivered
+        const char *bad[] = {"[1, 2", "{\"a\" 1}", "[\"\\x\"]", "[1] 2", "", "[1e999]", "[tru]"};
+        for (const char *b : bad)
+        {
+            sax_recorder r;
+            EXPECT_INT(parse(b).first, kkjson::parse_sax(b, r));
+        }
+        sax_recorder partial;
+        kkjson::parse_sax("[1, 2", partial);
+        EXPECT_STRING("[ll", partial.events);
+    }
+
+    void test_stream()
+    {
+        const std::string doc = " {\"a\\u00e9\": [null, true, -12, 1.5e2, \"x\\\"y\\ud83d\\ude00\"], \"b\": {}, \"c\": [[], 18446744073709551615]} ";
+        auto [st, expect] = parse(std::string_view(doc));
+
+        // every split point, also inside escapes, numbers and literals
+        kkjson::StreamParser sp;
+        for (size_t step : {1, 2, 3, 7, 64})
+        {
+            sp.reset();
+            for (size_t pos = 0; pos < doc.size(); pos += step)
+                EXPECT_INT(ParseStatus::OK, sp.feed(doc.substr(pos, step)));
+            EXPECT_INT(ParseStatus::OK, sp.finish());
+            EXPECT_BOOL(true, expect.dump() == sp.root().dump());
+        }
+        EXPECT_BOOL(true, sp.root()["c"][1].as_uint64() == UINT64_MAX);
+
+        // only the cut token is held back
+        sp.reset();
+        sp.feed("[\"abc");
+        EXPECT_SIZE_T(4, sp.buffered());
+        sp.feed("def\", 12");
+        EXPECT_SIZE_T(2, sp.buffered());
+        sp.feed("3]");
+        EXPECT_SIZE_T(0, sp.buffered());
+        EXPECT_INT(ParseStatus::OK, sp.finish());
+        EXPECT_INT(123, sp.root()[1].as_int64());
+
+        sax_recorder whole, pieces;
+        kkjson::parse_sax(doc, whole);
+        kkjson::StreamParser events(pieces);
+        for (char c : doc)
+            events.feed(&c, 1);
+        EXPECT_INT(ParseStatus::OK, events.finish());
+        EXPECT_BOOL(true, whole.events == pieces.events);
+
+        // errors match parse() of the whole input and stick
+        const char *bad[] = {"[1, 2", "{\"a\" 1}", "[\"\\x\"]", "[1] 2", "", "[1e999]", "[tru", "[1-2]", "{\"a", "[\"\\", "{\"a\":", "[0x1]"};
+        for (const char *b : bad)
+        {
+            sp.reset();
+            for (const char *c = b; *c != '\0'; c++)
+                sp.feed(c, 1);
+            EXPECT_INT(parse(b).first, sp.finish());
+            EXPECT_INT(parse(b).first, sp.feed("1"));
+        }
+
+        sax_recorder stop;
+        stop.stop_after = 2;
+        kkjson::StreamParser aborted(stop);
+        EXPECT_INT(ParseStatus::ABORTED, aborted.feed("[[1]]"));
+        EXPECT_INT(ParseStatus::ABORTED, aborted.finish());
+    }
+
+    void test_parse_parallel()
+    {
+        // brackets, commas and escaped quotes inside strings must not move the cuts
+        std::string doc = " [";
+        for (int i = 0; i < 30000; i++)
+        {
+            if (i)
+                doc += ",\n";
+            doc += "{\"id\": " + std::to_string(i) + ", \"s\": \"],[\\\"}{,\\\\\", \"a\": [[" + std::to_string(i % 7) + "], {}]}";
+        }
+        doc += "] ";
+        kkjson::ParseOptions serial, parallel;
+        parallel.threads = 4;
+        auto [st, expect] = parse(std::string_view(doc), serial);
+        auto [st2, js] = parse(std::string_view(doc), parallel);
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_INT(ParseStatus::OK, st2);
+        EXPECT_SIZE_T(30000, js.get_size());
+        EXPECT_BOOL(true, expect.dump() == js.dump());
+        parallel.threads = 0;
+        EXPECT_BOOL(true, expect.dump() == parse(std::string_view(doc), parallel).second.dump());
+        parallel.threads = 4;
+
+        // errors are reported by the serial parse
+        std::string bad[] = {doc + "1", doc.substr(0, doc.size() - 2), "{\"x\": " + doc + "}",
+                             doc.substr(0, doc.size() / 2) + "tru" + doc.substr(doc.size() / 2),
+                             doc.substr(0, doc.size() / 3) + "\"" + doc.substr(doc.size() / 3),
+                             doc.substr(0, doc.size() / 2) + ",," + doc.substr(doc.size() / 2)};
+        for (auto &b : bad)
+            EXPECT_INT(parse(std::string_view(b), serial).first, parse(std::string_view(b), parallel).first);
+        EXPECT_BOOL(true, expect.dump() == parse(std::string_view(bad[2]), parallel).second["x"].dump());
+
+        // a root array closed by '}' is no array, whatever the depth count says
+        std::string brace = "[";
+        for (int i = 0; i < 300000; i++)
+            brace += i ? ",12345" : "12345";
+        brace += "}";
+        EXPECT_BOOL(true, brace.size() >= 512 * 1024);
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, parse(std::string_view(brace), serial).first);
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, parse(std::string_view(brace), parallel).first);
+    }
+
+    void test_query()
+    {
+        const std::string doc = "{\"data\": {\"items\": [{\"price\": 1, \"n\": \"a\"}, {\"n\": \"b\"}, {\"price\": [2.5]}],"
+                                " \"a/b\": {\"~\": true}, \"0\": \"zero\"}, \"data\": null, \"skip\": [\"]\", {\"x\": 1}]}";
+        kkjson::Query q;
+        EXPECT_INT(ParseStatus::OK, q.add("/data/items/*/price"));
+        EXPECT_INT(ParseStatus::OK, q.add("$.data.items[1]"));
+        EXPECT_INT(ParseStatus::OK, q.add("/data/a~1b/~0"));
+        EXPECT_INT(ParseStatus::OK, q.add("$['data'][\"0\"]"));
+        EXPECT_INT(ParseStatus::OK, q.add("/data/items/0"));
+        EXPECT_INT(ParseStatus::OK, q.add("/data/items"));
+        EXPECT_INT(ParseStatus::OK, q.add("/missing"));
+        EXPECT_SIZE_T(7, q.size());
+
+        auto [st, matches] = q.run(doc);
+        EXPECT_INT(ParseStatus::OK, st);
+        // document order, a value matched by a path and the prefix of another is built for both
+        std::string got;
+        for (auto &m : matches)
+            got += std::to_string(m.path) + "=" + m.value.dump() + " ";
+        EXPECT_BOOL(true, got == "5=[{\"price\":1,\"n\":\"a\"},{\"n\":\"b\"},{\"price\":[2.5]}] 4={\"price\":1,\"n\":\"a\"} "
+                              "0=1 1={\"n\":\"b\"} 0=[2.5] 2=true 3=\"zero\" ");
+
+        // pointer tokens that look like indices also select members
+        kkjson::Query root;
+        EXPECT_INT(ParseStatus::OK, root.add(""));
+        EXPECT_INT(ParseStatus::OK, root.add("$"));
+        EXPECT_INT(ParseStatus::OK, root.add("/1"));
+        EXPECT_INT(ParseStatus::OK, root.add("$[1]"));
+        auto [st2, m2] = root.run("[10, 20]");
+        EXPECT_SIZE_T(4, m2.size());
+        EXPECT_INT(20, m2[3].value.as_int64());
+        EXPECT_SIZE_T(3, root.run("{\"1\": 5}").second.size());
+
+        const char *bad[] = {"a", "/~2", "/x~", "$..a", "$.", "$[a]", "$[01]", "$['x'", "$x"};
+        for (const char *b : bad)
+            EXPECT_INT(ParseStatus::INVALID_PATH, q.add(b));
+        EXPECT_SIZE_T(7, q.size());
+
+        // skipped parts are still checked
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, q.run("{\"skip\": [1 2], \"data\": 1}").first);
+        EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, q.run("{} 1").first);
+        EXPECT_SIZE_T(0, q.run("{\"data\": {\"items\": [{\"price\": 1}]}, \"x\": tru}").second.size());
+    }
+
+    void test_parser_reuse()
+    {
+        kkjson::Parser p;
+        const std::string doc = "{\"a\\n\": [1, \"x\\ty\", {\"b\\u00e9\": null}], \"c\": -2.5}";
+        for (int i = 0; i < 3; i++)
+        {
+            auto [st, js] = p.parse(doc);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_BOOL(true, js.dump() == parse(std::string_view(doc)).second.dump());
+        }
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, p.parse("[1 2]").first);
+        EXPECT_DOUBLE(-2.5, p.parse(doc).second["c"].as_number());
+
+        kkjson::Document d;
+        EXPECT_INT(ParseStatus::OK, p.parse(doc, d));
+        EXPECT_STRING("x\ty", d.root()["a\n"][1].as_string_view());
+        kkjson::Tape tape;
+        EXPECT_INT(ParseStatus::OK, p.parse(doc, tape));
+        EXPECT_INT(ValueType::Null, tape.root()["a\n"][2]["b\xC3\xA9"].get_type());
+        EXPECT_INT(ParseStatus::INVALID_VALUE, p.parse("[nul]", tape));
+        EXPECT_INT(ValueType::None, tape.root().get_type());
+        sax_recorder rec;
+        EXPECT_INT(ParseStatus::OK, p.parse_sax("[true, \"s\"]", rec));
+        EXPECT_STRING("[ts]", rec.events);
+        kkjson::ParseOptions indexed;
+        indexed.structural_index = true;
+        EXPECT_INT(ParseStatus::OK, p.parse(doc, indexed).first);
+        EXPECT_SIZE_T(10, p.stats().documents);
+        EXPECT_BOOL(true, p.stats().index_bytes > 0);
+
+        // a long escaped string grows the stack, it is kept below the limit and released above it
+        std::string big = "\"" + std::string(100000, 'a') + "\\n\"";
+        EXPECT_INT(ParseStatus::OK, p.parse(big).first);
+        size_t grown = p.stats().stack_bytes;
+        EXPECT_BOOL(true, grown > 100000);
+        EXPECT_INT(ParseStatus::OK, p.parse("[\"\\n\"]").first);
+        EXPECT_SIZE_T(grown, p.stats().stack_bytes);
+        EXPECT_SIZE_T(0, p.stats().shrinks);
+
+        p.set_retain_limit(4096);
+        EXPECT_INT(ParseStatus::OK, p.parse(big).first);
+        EXPECT_SIZE_T(1, p.stats().shrinks);
+        EXPECT_BOOL(true, p.stats().stack_bytes < 4096);
+        EXPECT_BOOL(true, p.stats().peak_stack_bytes >= grown);
+        EXPECT_SIZE_T(0, p.stats().index_bytes);
+        EXPECT_STRING("a\n", p.parse(big).second.as_string().substr(99999));
+
+        // so does the stack of open containers a deep document leaves behind
+        kkjson::ParseOptions deep_opts;
+        deep_opts.max_depth = 10000;
+        std::string deep = std::string(5000, '[') + std::string(5000, ']');
+        p.set_retain_limit(kkjson::PARSER_RETAIN_LIMIT);
+        EXPECT_INT(ParseStatus::OK, p.parse(deep, deep_opts).first);
+        EXPECT_BOOL(true, p.stats().frame_bytes > 0);
+        EXPECT_BOOL(true, p.stats().peak_frame_bytes >= p.stats().frame_bytes);
+        p.shrink();
+        EXPECT_SIZE_T(0, p.stats().frame_bytes);
+        p.set_retain_limit(4096);
+        size_t shrinks = p.stats().shrinks;
+        EXPECT_INT(ParseStatus::OK, p.parse(deep, deep_opts).first);
+        EXPECT_SIZE_T(shrinks + 1, p.stats().shrinks);
+        EXPECT_SIZE_T(0, p.stats().frame_bytes);
+    }
+
+    void test_parse_file()
+    {
+        char path[] = "/tmp/kkjson_test_XXXXXX";
+        close(mkstemp(path));
+        // a new file each time, truncating a mapped one would fault
+        auto write_file = [&](const std::string &content)
+        {
+            unlink(path);
+            FILE *f = std::fopen(path, "wb");
+            EXPECT_SIZE_T(content.size(), std::fwrite(content.data(), 1, content.size(), f));
+            std::fclose(f);
+        };
+
+        // a long string that ends exactly at the end of a page, and one byte short of it
+        for (size_t size : {size_t(4096), size_t(4095), size_t(8192 + 17)})
+        {
+            std::string doc = "[\"" + std::string(size - 4, 'x') + "\"]";
+            write_file(doc);
+            auto [st, js] = kkjson::parse_file(path);
+            EXPECT_INT(ParseStatus::OK, st);
+            EXPECT_SIZE_T(size - 4, js[0].as_string_view().size());
+        }
+        write_file("{\"a\": [1, 2, \"\\u00e9\"], \"b\": \"in the file\"}");
+        auto [st2, js2] = kkjson::parse_file(path);
+        EXPECT_STRING("\xC3\xA9", js2["a"][2].as_string());
+
+        // borrowed strings point into the mapping, which the document keeps
+        kkjson::Document doc;
+        kkjson::ParseOptions borrow;
+        borrow.borrow_strings = true;
+        EXPECT_INT(ParseStatus::OK, doc.parse_file(path, borrow));
+        write_file("[]");
+        EXPECT_STRING("in the file", doc.root()["b"].as_string_view());
+        EXPECT_INT(ParseStatus::OK, doc.parse_file(path));
+        EXPECT_SIZE_T(0, doc.root().get_size());
+
+        write_file("");
+        EXPECT_INT(ParseStatus::UNEXPECTED_SYMBOL, kkjson::parse_file(path).first);
+        write_file("[1,");
+        EXPECT_INT(ParseStatus::UNEXPECTED_SYMBOL, doc.parse_file(path));
+        EXPECT_INT(ValueType::None, doc.root().get_type());
+        unlink(path);
+        EXPECT_INT(ParseStatus::FILE_UNREADABLE, kkjson::parse_file(path).first);
+        EXPECT_INT(ParseStatus::FILE_UNREADABLE, kkjson::parse_file("/tmp").first);
+        EXPECT_INT(ParseStatus::FILE_UNREADABLE, doc.parse_file(path));
+    }
+
+    void test_ndjson()
+    {
+        std::string lines = "{\"id\": 0}\n\n  \r\n[1, \"a\\nb\"]\r\n{\"id\": \n2}\ntrue";
+        kkjson::NdjsonOptions opts;
+        auto results = kkjson::parse_ndjson(lines, opts);
+        EXPECT_SIZE_T(5, results.size());
+        EXPECT_INT(ParseStatus::OK, results[0].first);
+        EXPECT_INT(0, results[0].second["id"].as_int64());
+        EXPECT_STRING("a\nb", results[1].second[1].as_string());
+        // a raw line break ends the document, also inside a value
+        EXPECT_INT(ParseStatus::UNEXPECTED_SYMBOL, results[2].first);
+        EXPECT_INT(ParseStatus::ROOT_NOT_SINGULAR, results[3].first);
+        EXPECT_BOOL(true, results[4].second.as_bool());
+
+        // many documents over several threads, in order
+        std::string many;
+        for (int i = 0; i < 20000; i++)
+            many += "{\"id\": " + std::to_string(i) + ", \"pad\": \"" + std::string(i % 97, 'x') + "\"}\n";
+        opts.threads = 4;
+        results = kkjson::parse_ndjson(many, opts);
+        EXPECT_SIZE_T(20000, results.size());
+        bool in_order = true;
+        for (size_t i = 0; i < results.size(); i++)
+            in_order &= results[i].first == ParseStatus::OK && results[i].second["id"].as_uint64() == i;
+        EXPECT_BOOL(true, in_order);
+
+        std::atomic<size_t> count(0), id_sum(0);
+        auto callback = [&](size_t idx, ParseStatus st, json &js)
+        {
+            if (st == ParseStatus::OK && js["id"].as_uint64() == idx)
+                id_sum += idx;
+            count++;
+        };
+        kkjson::parse_ndjson(many, callback, opts);
+        EXPECT_SIZE_T(20000, count.load());
+        EXPECT_SIZE_T(size_t(19999) * 20000 / 2, id_sum.load());
+
+        // the reader hands over whole lines of a file larger than one block
+        FILE *f = std::tmpfile();
+        for (int i = 0; i < 3; i++)
+            std::fwrite(many.data(), 1, many.size(), f);
+        std::fputs("[1]", f);
+        std::fflush(f);
+        std::rewind(f);
+        count = 0, id_sum = 0;
+        opts.queue_depth = 1;
+        EXPECT_BOOL(true, kkjson::parse_ndjson_fd(fileno(f), [&](size_t idx, ParseStatus st, json &js)
+                                                  {
+                                                      if (st == ParseStatus::OK && (js.is_array() || js["id"].as_uint64() == idx % 20000))
+                                                          id_sum++;
+                                                      count++; }, opts));
+        EXPECT_SIZE_T(60001, count.load());
+        EXPECT_SIZE_T(60001, id_sum.load());
+        std::fclose(f);
+        EXPECT_BOOL(false, kkjson::parse_ndjson_fd(-1, callback, opts));
+
+        // a line several blocks long grows the buffer, the lines around it are kept
+        f = std::tmpfile();
+        std::string long_line = "\"" + std::string(5 << 20, 'x') + "\"";
+        std::fputs("[1]\n", f);
+        std::fwrite(long_line.data(), 1, long_line.size(), f);
+        std::fputs("\n[2]\n[3]", f);
+        std::fflush(f);
+        std::rewind(f);
+        std::vector<size_t> sizes(4);
+        EXPECT_BOOL(true, kkjson::parse_ndjson_fd(fileno(f), [&](size_t idx, ParseStatus st, json &js)
+                                                  {
+                                                      if (st == ParseStatus::OK && idx < sizes.size())
+                                                          sizes[idx] = js.is_string() ? js.as_string_view().size() : js.get_size(); }, opts));
+        EXPECT_SIZE_T(1, sizes[0]);
+        EXPECT_SIZE_T(5 << 20, sizes[1]);
+        EXPECT_SIZE_T(1, sizes[2]);
+        EXPECT_SIZE_T(1, sizes[3]);
+        std::fclose(f);
+    }
+
+    void test_small_string()
+    {
+        // the inline bytes are part of the 16 a value takes anyway
+        EXPECT_SIZE_T(16, sizeof(json));
+        auto [st, js] = parse("[\"\", \"ok\", \"twelve bytes\", \"thirteen byte\", \"caf\\u00e9\"]");
+        EXPECT_INT(ParseStatus::OK, st);
+        EXPECT_STRING("", js[0].as_string_view());
+        EXPECT_STRING("ok", js[1].as_string_view());
+        EXPECT_STRING("twelve bytes", js[2].as_string_view());
+        EXPECT_STRING("thirteen byte", js[3].as_string_view());
+        EXPECT_SIZE_T(12, js[2].get_size());
+        EXPECT_SIZE_T(13, js[3].get_size());
+        EXPECT_STRING("caf\xc3\xa9", js[4].as_string_view());
+        // stored in the value, moving it moves the bytes
+        const char *inside = reinterpret_cast<const char *>(&js[2]);
+        EXPECT_BOOL(true, js[2].as_string_view().data() > inside && js[2].as_string_view().data() < inside + sizeof(json));
+
+        json copy = js[1];
+        json moved = std::move(js[2]);
+        EXPECT_STRING("ok", copy.as_string_view());
+        EXPECT_STRING("twelve bytes", moved.as_string_view());
+        EXPECT_INT(ValueType::None, js[2].get_type());
+
+        // as_string() hands out an owned string that may grow past the inline size
+        copy.as_string() += " and longer than twelve";
+        EXPECT_STRING("ok and longer than twelve", copy.as_string_view());
+        moved = json(std::string("short"));
+        EXPECT_STRING("short", moved.as_string());
+        moved = copy;
+        EXPECT_STRING("ok and longer than twelve", moved.as_string_view());
+        moved = json(std::string("x"));
+        EXPECT_STRING("x", moved.as_string_view());
+
+        kkjson::Document doc;
+        EXPECT_INT(ParseStatus::OK, doc.parse("{\"a\": \"arena\", \"b\": \"longer arena string\"}"));
+        EXPECT_STRING("arena", doc.root()["a"].as_string_view());
+        EXPECT_STRING("longer arena string", doc.root()["b"].as_string_view());
+        json out = doc.root();
+        doc.reset();
+        EXPECT_STRING("{\"a\":\"arena\",\"b\":\"longer arena string\"}", out.dump());
+    }
+
+    void test_depth_limit()
+    {
+        // far deeper than any call stack would take, every engine stops at the limit
+        std::string deep = std::string(100000, '[') + std::string(100000, ']');
+        kkjson::ParseOptions indexed, sax_opts;
+        indexed.structural_index = true;
+        sax_recorder rec;
+        kkjson::Tape tape;
+        kkjson::StreamParser sp;
+        kkjson::Query q;
+        EXPECT_INT(ParseStatus::OK, q.add("/0/0"));
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse(std::string_view(deep)).first);
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse(std::string_view(deep), indexed).first);
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, kkjson::validate(deep).first);
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, kkjson::parse_sax(deep, rec));
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, tape.parse(deep));
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, sp.feed(deep));
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, q.run(deep).first);
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, kkjson::parse_lazy(deep).second.get().first);
+
+        // exactly max_depth containers pass, one more fails the same way everywhere
+        kkjson::ParseOptions opts;
+        opts.max_depth = 3;
+        indexed.max_depth = 3;
+        const char *ok[] = {"[[[]]]", "{\"a\": [{}]}", "[1, [2, [3]], {\"b\": [4]}]", "\"no container\""};
+        const char *bad[] = {"[[[[]]]]", "{\"a\": [{\"b\": []}]}", "[1, [2, [3, [4]]]]", "[[[{\"open\": "};
+        kkjson::StreamParser limited(opts), limited_events(rec, opts);
+        for (auto doc : ok)
+        {
+            EXPECT_INT(ParseStatus::OK, parse(doc, std::strlen(doc), opts).first);
+            EXPECT_INT(ParseStatus::OK, parse(doc, std::strlen(doc), indexed).first);
+            EXPECT_INT(ParseStatus::OK, kkjson::validate(doc, opts).first);
+            EXPECT_INT(ParseStatus::OK, kkjson::parse_sax(doc, rec, opts));
+            EXPECT_INT(ParseStatus::OK, tape.parse(doc, opts));
+            limited.reset();
+            limited_events.reset();
+            EXPECT_INT(ParseStatus::OK, limited.feed(doc));
+            EXPECT_INT(ParseStatus::OK, limited.finish());
+            EXPECT_INT(ParseStatus::OK, limited_events.feed(doc));
+            EXPECT_INT(ParseStatus::OK, limited_events.finish());
+        }
+        for (auto doc : bad)
+        {
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse(doc, std::strlen(doc), opts).first);
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse(doc, std::strlen(doc), indexed).first);
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, kkjson::validate(doc, opts).first);
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, kkjson::parse_sax(doc, rec, opts));
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, tape.parse(doc, opts));
+            limited.reset();
+            limited_events.reset();
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, limited.feed(doc));
+            EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, limited_events.feed(doc));
+        }
+        // the first error in the input wins
+        EXPECT_INT(ParseStatus::MISS_ARRAY_SYMBOL, parse("[[1 [[[[]]]]]]", 14, opts).first);
+        opts.max_depth = 0;
+        EXPECT_INT(ParseStatus::OK, parse("12", 2, opts).first);
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse("[]", 2, opts).first);
+
+        // elements split across threads count the outer array as well
+        std::string wide = "[" + std::string(1 << 19, ' ') + "[[1]], [[2]], 3]";
+        kkjson::ParseOptions parallel;
+        parallel.threads = 4;
+        parallel.max_depth = 3;
+        EXPECT_INT(ParseStatus::OK, parse(std::string_view(wide), parallel).first);
+        parallel.max_depth = 2;
+        EXPECT_INT(ParseStatus::DEPTH_EXCEEDED, parse(std::string_view(wide), parallel).first);
+
+        // the tree is still built without recursion up to a raised limit
+        opts.max_depth = 200000;
+        std::string nested = std::string(5000, '[') + "\"x\"" + std::string(5000, ']');
+        auto [st, js] = parse(std::string_view(nested), opts);
+        EXPECT_INT(ParseStatus::OK, st);
+        const json *v = &js;
+        for (int i = 0; i < 5000; i++)
+            v = &(*v)[0];
+        EXPECT_STRING("x", v->as_string_view());
+        kkjson::StreamParser raised(opts);
+        EXPECT_INT(ParseStatus::OK, raised.feed(nested));
+        EXPECT_INT(ParseStatus::OK, raised.finish());
+    }
+
+    void test_string_pool()
+    {
+        kkjson::StringPool pool(20);
+        kkjson::ParseOptions opts;
+        opts.intern = &pool;
+        auto [st1, a] = parse("{\"id\": 1, \"level\": \"disk-usage-warning\", \"msg\": \"disk almost full on /var/lib\", \"t\\u0061g\": \"x\"}", opts);
+        auto [st2, b] = parse("[{\"level\": \"disk-usage-warning\", \"tag\": \"y\", \"id\": 2, \"id\": 3}]", opts);
+        EXPECT_INT(ParseStatus::OK, st1);
+        EXPECT_INT(ParseStatus::OK, st2);
+        EXPECT_STRING("{\"id\":1,\"level\":\"disk-usage-warning\",\"msg\":\"disk almost full on /var/lib\",\"tag\":\"x\"}", a.dump());
+        EXPECT_STRING("[{\"level\":\"disk-usage-warning\",\"tag\":\"y\",\"id\":2}]", b.dump());
+
+        // keys and mid-sized values of both documents share one copy, the long value has its own
+        // and the short ones are stored inline
+        auto key_of = [](const json &obj, size_t i)
+        {
+            auto it = obj.object_begin();
+            while (i-- > 0)
+                ++it;
+            return it->first.data();
+        };
+        EXPECT_BOOL(true, key_of(a, 1) == key_of(b[0], 0));
+        EXPECT_BOOL(true, key_of(a, 3) == key_of(b[0], 1));
+        EXPECT_BOOL(true, a["level"].as_string_view().data() == b[0]["level"].as_string_view().data());
+        EXPECT_BOOL(true, a["msg"].as_string_view().data() != pool.intern("disk almost full on /var/lib").data());
+        EXPECT_BOOL(true, pool.intern("level").data() == key_of(a, 1));
+        EXPECT_BOOL(true, a["tag"].as_string_view().data() != pool.intern("x").data());
+        EXPECT_SIZE_T(7, pool.size());
+
+        // members added later are interned too, copies own their keys and drop the pool
+        b[0]["host"] = json(std::string("db1"));
+        EXPECT_BOOL(true, key_of(b[0], 3) == pool.intern("host").data());
+        json c = a;
+        a = json();
+        EXPECT_STRING("disk-usage-warning", c["level"].as_string_view());
+        c["id"] = json(int64_t(5));
+        EXPECT_STRING("{\"id\":5,\"level\":\"disk-usage-warning\",\"msg\":\"disk almost full on /var/lib\",\"tag\":\"x\"}", c.dump());
+
+        // the arena, index and parallel builds use it the same way
+        kkjson::Document doc;
+        EXPECT_INT(ParseStatus::OK, doc.parse("{\"level\": \"disk-usage-critical\", \"tag\": \"z\"}", opts));
+        EXPECT_BOOL(true, doc.root()["level"].as_string_view().data() == pool.intern("disk-usage-critical").data());
+        EXPECT_BOOL(true, key_of(doc.root(), 1) == pool.intern("tag").data());
+        kkjson::ParseOptions indexed = opts;
+        indexed.structural_index = true;
+        auto [st3, d] = parse("{\"tag\": \"disk-usage-warning\"}", indexed);
+        EXPECT_BOOL(true, key_of(d, 0) == pool.intern("tag").data());
+        std::string lines;
+        for (int i = 0; i < 200; i++)
+            lines += "{\"level\": \"disk-usage-warning\", \"n\": " + std::to_string(i) + "}\n";
+        kkjson::NdjsonOptions nd;
+        nd.threads = 4;
+        nd.parse = opts;
+        auto docs = kkjson::parse_ndjson(lines, nd);
+        EXPECT_SIZE_T(200, docs.size());
+        bool shared = true;
+        for (auto &[st, v] : docs)
+            shared &= st == ParseStatus::OK && v["level"].as_string_view().data() == pool.intern("disk-usage-warning").data();
+        EXPECT_BOOL(true, shared);
+
+        size_t before = pool.size();
+        docs.clear();
+        c = json();
+        b = json();
+        d = json();
+        doc.reset();
+        pool.clear();
+        EXPECT_BOOL(true, before > 7);
+        EXPECT_SIZE_T(0, pool.size());
+        EXPECT_SIZE_T(0, pool.bytes());
+        EXPECT_STRING("[\"a\"]", parse("[\"a\"]", opts).second.dump());
+    }
+
+    void test_validate()
+    {
+        // same verdict as a full parse, nothing is built
+        const char *docs[] = {"{\"a\": [1, -2.5e3, true, null, \"x\\u00e9\\ud83d\\ude00\"]}", " [] ", "0", "-0.0e+1",
+                              "", "  ", "[1 2]", "[1,]", "{\"a\" 1}", "{1: 2}", "{\"a\": 1,}", "01", "0x1", "1.", "-", "1e",
+                              "\"\\x\"", "\"\\u12g4\"", "\"\\ud83d\"", "\"\\ud83d\\u0041\"", "\"\x01\"", "\"abc",
+                              "1e400", "-1e999", "1e-400", "123456789012345678901234567890e290", "tru", "nul", "1 2", "[[[]]"};
+        for (const char *d : docs)
+        {
+            auto [st, off] = kkjson::validate(d);
+            EXPECT_INT(parse(d).first, st);
+            EXPECT_BOOL(true, off <= std::strlen(d));
+        }
+
+        // the offset is the end of the input on success and points into it on failure
+        EXPECT_BOOL(true, kkjson::validate(" [1, 2] ") == std::make_pair(ParseStatus::OK, size_t(8)));
+        EXPECT_BOOL(true, kkjson::validate("[1, 2 3]") == std::make_pair(ParseStatus::MISS_ARRAY_SYMBOL, size_t(6)));
+        EXPECT_BOOL(true, kkjson::validate("[\"ab\\q\"]") == std::make_pair(ParseStatus::INVALID_STRING_ESCAPE, size_t(4)));
+        EXPECT_BOOL(true, kkjson::validate("{} x") == std::make_pair(ParseStatus::ROOT_NOT_SINGULAR, size_t(3)));
+
+        kkjson::ParseOptions padded;
+        padded.padded = true;
+        std::string buf = "{\"k\": \"v\"}" + std::string(kkjson::PARSE_PADDING, '\0');
+        EXPECT_INT(ParseStatus::OK, kkjson::validate(std::string_view(buf.data(), 10), padded).first);
+    }
+
     void test_array_iterator()
     {
         auto [st, js] = parse("[1, 2, 3, 4, 5]");
@@ -493,29 +1692,57 @@ namespace
 int main()
 {
     output_keys();
-    test_parse_literal();
-    test_parse_number();
-    test_parse_string();
-    test_parse_array();
-    test_parse_object();
-
-    test_error_unexpected_symbol();
-    test_error_invalid_value();
-    test_error_root_not_singular();
-    // number
-    test_error_number_too_large();
-    // string
-    test_error_miss_quotation_mark();
-    test_error_invalid_string_escape();
-    test_error_invalid_string_char();
-    // unicode
-    test_error_invalid_unicode_hex();
-    test_error_invalid_unicode_surrogate();
-    // array
-    test_error_miss_array_symbol();
-    // object
-    test_error_miss_object_key();
-    test_error_miss_object_symbol();
+    for (bool indexed : {false, true})
+    {
+        engine_opts.structural_index = indexed;
+        test_parse_literal();
+        test_parse_number();
+        test_parse_number_rounding();
+        test_parse_integer();
+        test_parse_string();
+        test_parse_array();
+        test_parse_object();
+
+        test_error_unexpected_symbol();
+        test_error_invalid_value();
+        test_error_root_not_singular();
+        // number
+        test_error_number_too_large();
+        // string
+        test_error_miss_quotation_mark();
+        test_error_invalid_string_escape();
+        test_error_invalid_string_char();
+        // unicode
+        test_error_invalid_unicode_hex();
+        test_error_invalid_unicode_surrogate();
+        // array
+        test_error_miss_array_symbol();
+        // object
+        test_error_miss_object_key();
+        test_error_miss_object_symbol();
+    }
+
+    test_parse_bounded();
+    test_parse_whitespace();
+    test_parse_long_string();
+    test_parse_borrowed();
+    test_document();
+    test_object_storage();
+    test_dump();
+    test_structural_index();
+    test_tape();
+    test_lazy();
+    test_sax();
+    test_stream();
+    test_parse_parallel();
+    test_parse_file();
+    test_parser_reuse();
+    test_query();
+    test_ndjson();
+    test_validate();
+    test_string_pool();
+    test_small_string();
+    test_depth_limit();
 
     // iterator
     test_array_iterator();